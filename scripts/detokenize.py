@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Host-side tools for BQ25895 tokenized logging (-DBQ25895_LOG_TOKENIZED).
+
+  detokenize.py database src/*.cpp > tokens.csv    # build the token database
+  detokenize.py decode tokens.csv capture.bin      # decode a raw serial capture
+"""
+
+import argparse
+import csv
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xB7
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D", 5: "T"}
+MODULES = {0: "CORE", 1: "I2C", 2: "INIT", 3: "POWER", 4: "FAULT", 5: "SAFETY", 6: "DIAG"}
+
+# BQ25895_LOGx(module, "format" "continued", args...)
+LOG_CALL = re.compile(r'BQ25895_LOG[EWIDT]\s*\(\s*\w+\s*,\s*((?:"(?:[^"\\]|\\.)*"\s*)+)')
+LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"')
+CONVERSION = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z|j|t|L)?([diouxXcfeEgGs%])')
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+
+def fnv1a(data):
+    """Same hash as BQ25895LogToken() in BQ25895Log.h."""
+    h = 2166136261
+    for byte in data:
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def unescape(literal):
+    return re.sub(r'\\(.)', lambda m: ESCAPES.get(m.group(1), m.group(1)), literal)
+
+
+def build_database(paths):
+    tokens = {}
+    for path in paths:
+        with open(path, encoding="utf-8") as source:
+            text = source.read()
+        for call in LOG_CALL.finditer(text):
+            fmt = "".join(unescape(part) for part in LITERAL.findall(call.group(1)))
+            token = fnv1a(fmt.encode("utf-8"))
+            if tokens.get(token, fmt) != fmt:
+                sys.stderr.write("warning: token collision 0x%08X: %r / %r\n" % (token, tokens[token], fmt))
+            tokens[token] = fmt
+    writer = csv.writer(sys.stdout)
+    for token in sorted(tokens):
+        writer.writerow(["%08X" % token, tokens[token]])
+
+
+def load_database(path):
+    with open(path, encoding="utf-8", newline="") as db:
+        return {int(row[0], 16): row[1] for row in csv.reader(db) if row}
+
+
+def read_varint(payload, pos):
+    value, shift = 0, 0
+    while True:
+        byte = payload[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return (value >> 1) ^ -(value & 1), pos
+
+
+def format_frame(fmt, payload):
+    args, pos = [], 0
+    try:
+        for conversion in CONVERSION.findall(fmt):
+            if conversion == "%":
+                continue
+            if conversion == "s":
+                length = payload[pos]
+                args.append(payload[pos + 1:pos + 1 + length].decode("utf-8", "replace"))
+                pos += 1 + length
+            elif conversion in "feEgG":
+                args.append(struct.unpack_from("<f", payload, pos)[0])
+                pos += 4
+            else:
+                value, pos = read_varint(payload, pos)
+                args.append(value & 0xFFFFFFFF if conversion in "uxXo" and value < 0 else value)
+    except (IndexError, struct.error):
+        return fmt + " <truncated>"
+    # Python's % accepts the C conversions used by the driver and ignores length modifiers
+    return fmt % tuple(args)
+
+
+def decode_stream(data, tokens):
+    pos = 0
+    while pos + 2 <= len(data):
+        if data[pos] != FRAME_SYNC:
+            pos += 1
+            continue
+        end = pos + 2 + data[pos + 1]
+        if data[pos + 1] < 5 or end > len(data):
+            pos += 1
+            continue
+        frame = data[pos + 2:end]
+        token = struct.unpack_from("<I", frame, 1)[0]
+        level = LEVELS.get(frame[0] >> 4, "?")
+        module = MODULES.get(frame[0] & 0x0F, str(frame[0] & 0x0F))
+        if token in tokens:
+            text = format_frame(tokens[token], frame[5:])
+        else:
+            text = "<unknown token 0x%08X>" % token
+        yield "%s %-6s %s" % (level, module, text)
+        pos = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command")
+    database = commands.add_parser("database", help="extract log format strings into a token database")
+    database.add_argument("sources", nargs="+")
+    decode = commands.add_parser("decode", help="decode tokenized frames")
+    decode.add_argument("database")
+    decode.add_argument("input", nargs="?", default="-")
+    options = parser.parse_args()
+
+    if options.command == "database":
+        build_database(options.sources)
+    elif options.command == "decode":
+        tokens = load_database(options.database)
+        stream = sys.stdin.buffer if options.input == "-" else open(options.input, "rb")
+        for line in decode_stream(stream.read(), tokens):
+            print(line)
+    else:
+        parser.print_help()
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,116 @@
+#include "BQ25895BrownoutPredictor.h"
+
+void BQ25895BrownoutPredictor::configure(const BQ25895BrownoutConfig& config) {
+    config_ = config;
+    if (config_.confirmSamples == 0) {
+        config_.confirmSamples = 1;
+    }
+    enabled_ = true;
+    started_ = false;
+    slopeX16_ = 0;
+    batterySlopeX16_ = 0;
+    timeToThresholdMs_ = BQ25895_BROWNOUT_NEVER;
+    confirmations_ = 0;
+    warning_ = false;
+    warnings_ = 0;
+    lastWarning_ = 0;
+}
+
+int32_t BQ25895BrownoutPredictor::smooth(int32_t filteredX16, int32_t previousMV, int32_t currentMV, uint32_t dt) {
+    // mV/ms * 1000 = mV/s; x16 keeps a fraction through the EMA
+    int32_t sampleX16 = (currentMV - previousMV) * 16000 / static_cast<int32_t>(dt);
+    return filteredX16 + (sampleX16 - filteredX16) / 2;
+}
+
+bool BQ25895BrownoutPredictor::update(uint32_t timestamp, uint16_t systemMV, uint16_t batteryMV) {
+    if (!enabled_ || systemMV == 0) {
+        return false;
+    }
+
+    uint32_t dt = timestamp - lastSample_;
+    if (!started_ || dt > config_.maxSampleGapMs) {
+        started_ = true;
+        slopeX16_ = 0;
+        batterySlopeX16_ = 0;
+        timeToThresholdMs_ = BQ25895_BROWNOUT_NEVER;
+        confirmations_ = 0;
+        dt = 0;
+    } else if (dt == 0) {
+        return false;
+    } else {
+        slopeX16_ = smooth(slopeX16_, systemMV_, systemMV, dt);
+        if (batteryMV != 0 && batteryMV_ != 0) {
+            batterySlopeX16_ = smooth(batterySlopeX16_, batteryMV_, batteryMV, dt);
+        }
+    }
+    lastSample_ = timestamp;
+    systemMV_ = systemMV;
+    batteryMV_ = batteryMV;
+
+    // Projection: remaining headroom over the falling slope (fits 32 bits: 65535 * 16000)
+    uint32_t previous = timeToThresholdMs_;
+    if (systemMV <= config_.thresholdMV) {
+        timeToThresholdMs_ = 0;
+    } else if (slopeX16_ < 0) {
+        uint32_t headroomMV = systemMV - config_.thresholdMV;
+        timeToThresholdMs_ = headroomMV * 16000 / static_cast<uint32_t>(-slopeX16_);
+    } else {
+        timeToThresholdMs_ = BQ25895_BROWNOUT_NEVER;
+    }
+
+    bool nearThreshold = systemMV <= config_.thresholdMV + config_.marginMV;
+    if (warning_) {
+        if (!nearThreshold && (timeToThresholdMs_ == BQ25895_BROWNOUT_NEVER ||
+                               timeToThresholdMs_ / 2 > config_.leadTimeMs)) {
+            warning_ = false;
+            confirmations_ = 0;
+        }
+        return false;
+    }
+
+    // A trend keeps pulling the projection in; after a load step settles it moves out again.
+    // The confirmation samples are taken out of the lead time rather than added to the delay.
+    uint32_t window = config_.leadTimeMs + static_cast<uint32_t>(config_.confirmSamples) * dt;
+    if (timeToThresholdMs_ <= window && timeToThresholdMs_ <= previous) {
+        if (confirmations_ < config_.confirmSamples) {
+            confirmations_++;
+        }
+    } else {
+        confirmations_ = 0;
+    }
+    if (!nearThreshold && confirmations_ < config_.confirmSamples) {
+        return false;
+    }
+
+    warning_ = true;
+    if (warnings_ < 0xFFFF) {
+        warnings_++;
+    }
+    lastWarning_ = timestamp;
+    if (hook_) {
+        BQ25895BrownoutWarning warning;
+        warning.timestamp = timestamp;
+        warning.systemMV = systemMV;
+        warning.batteryMV = batteryMV;
+        warning.slopeMVPerS = slopeX16_ / 16;
+        warning.timeToThresholdMs = timeToThresholdMs_;
+        hook_(warning);
+    }
+    return true;
+}
+
+BQ25895BrownoutState BQ25895BrownoutPredictor::state() const {
+    BQ25895BrownoutState state;
+    state.enabled = enabled_;
+    if (!enabled_ || !started_) {
+        return state;
+    }
+    state.warning = warning_;
+    state.systemMV = systemMV_;
+    state.slopeMVPerS = slopeX16_ / 16;
+    state.batterySlopeMVPerS = batterySlopeX16_ / 16;
+    state.timeToThresholdMs = timeToThresholdMs_;
+    state.warnings = warnings_;
+    state.lastWarning = lastWarning_;
+    return state;
+}
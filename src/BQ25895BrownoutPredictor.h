@@ -0,0 +1,74 @@
+#ifndef BQ25895_BROWNOUT_PREDICTOR_H
+#define BQ25895_BROWNOUT_PREDICTOR_H
+
+#include <stdint.h>
+
+#define BQ25895_BROWNOUT_NEVER 0xFFFFFFFFUL   // timeToThresholdMs when VSYS is not falling
+
+struct BQ25895BrownoutConfig {
+  uint16_t thresholdMV = 3400;        // VSYS level the system browns out at
+  uint32_t leadTimeMs = 5000;         // Warn when the projected crossing is this close
+  uint16_t marginMV = 100;            // Warn within this of the threshold whatever the trend
+  uint8_t confirmSamples = 2;         // Consecutive projections inside the lead time needed
+  uint32_t maxSampleGapMs = 10000;    // Longer gaps restart the trend
+};
+
+// Passed to the hook once per brownout episode
+struct BQ25895BrownoutWarning {
+  uint32_t timestamp = 0;
+  uint16_t systemMV = 0;
+  uint16_t batteryMV = 0;
+  int32_t slopeMVPerS = 0;            // Filtered VSYS slope (negative = falling)
+  uint32_t timeToThresholdMs = 0;     // Projected time until VSYS reaches the threshold
+};
+
+typedef void (*BQ25895BrownoutHook)(const BQ25895BrownoutWarning& warning);
+
+struct BQ25895BrownoutState {
+  bool enabled = false;
+  bool warning = false;               // Inside a brownout episode (hook already fired)
+  uint16_t systemMV = 0;
+  int32_t slopeMVPerS = 0;
+  int32_t batterySlopeMVPerS = 0;     // BATV trend: separates a discharging cell from a load step
+  uint32_t timeToThresholdMs = BQ25895_BROWNOUT_NEVER;
+  uint16_t warnings = 0;
+  uint32_t lastWarning = 0;
+};
+
+// VSYS trend in fixed point: per-sample slopes in 1/16 mV/s, smoothed with a 1/2 EMA. A warning
+// needs confirmSamples projections inside the lead time, each no later than the one before, so a
+// load step that settles (projection moving back out) does not fire; being within marginMV does.
+// The warning re-arms once VSYS is back above the margin and the projection is beyond twice the
+// lead time.
+class BQ25895BrownoutPredictor {
+public:
+  void configure(const BQ25895BrownoutConfig& config);
+  void disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+  void setHook(BQ25895BrownoutHook hook) { hook_ = hook; }
+
+  // Returns true when a warning fired on this sample
+  bool update(uint32_t timestamp, uint16_t systemMV, uint16_t batteryMV);
+
+  BQ25895BrownoutState state() const;
+
+private:
+  static int32_t smooth(int32_t filteredX16, int32_t previousMV, int32_t currentMV, uint32_t dt);
+
+  BQ25895BrownoutConfig config_;
+  BQ25895BrownoutHook hook_ = nullptr;
+  bool enabled_ = false;
+  bool started_ = false;
+  uint32_t lastSample_ = 0;
+  uint16_t systemMV_ = 0;
+  uint16_t batteryMV_ = 0;
+  int32_t slopeX16_ = 0;              // VSYS slope, 1/16 mV/s
+  int32_t batterySlopeX16_ = 0;
+  uint32_t timeToThresholdMs_ = BQ25895_BROWNOUT_NEVER;
+  uint8_t confirmations_ = 0;
+  bool warning_ = false;
+  uint16_t warnings_ = 0;
+  uint32_t lastWarning_ = 0;
+};
+
+#endif // BQ25895_BROWNOUT_PREDICTOR_H
@@ -0,0 +1,120 @@
+#include "BQ25895ChargePredictor.h"
+
+#include <math.h>
+
+const uint16_t BQ25895ChargePredictor::kCvMarginMV;
+
+void BQ25895ChargePredictor::reset() {
+    prediction_ = BQ25895TimePrediction();
+    lastPhase_ = BQ25895ChargePhase::IDLE;
+    chargeAvgX16_ = 0;
+    dischargeAvgX16_ = 0;
+    cvChargeMAh_ = 0;
+    cvStartMA_ = 0;
+    cvStartTime_ = 0;
+    tauS_ = 0;
+}
+
+void BQ25895ChargePredictor::update(const BQ25895PredictorSample& sample) {
+    BQ25895ChargePhase phase;
+    if (!sample.externalPower) {
+        phase = BQ25895ChargePhase::DISCHARGING;
+    } else if (sample.chargeStatus == BQ25895_CHRG_STAT_TERMINATED) {
+        phase = BQ25895ChargePhase::DONE;
+    } else if (sample.chargeStatus == BQ25895_CHRG_STAT_PRE_CHARGE) {
+        phase = BQ25895ChargePhase::PRE_CHARGE;
+    } else if (sample.chargeStatus == BQ25895_CHRG_STAT_FAST_CHARGE) {
+        // CV is sticky for the rest of the session so BATV noise cannot flip it back
+        bool atVreg = sample.batteryMV + kCvMarginMV >= sample.chargeVoltageMV;
+        phase = (atVreg || lastPhase_ == BQ25895ChargePhase::CONSTANT_VOLTAGE)
+                    ? BQ25895ChargePhase::CONSTANT_VOLTAGE : BQ25895ChargePhase::CONSTANT_CURRENT;
+    } else {
+        phase = BQ25895ChargePhase::IDLE;
+    }
+
+    uint16_t chargeMA = sample.batteryCurrentMA > 0 ? static_cast<uint16_t>(sample.batteryCurrentMA) : 0;
+    uint16_t dischargeMA = sample.batteryCurrentMA < 0 ? static_cast<uint16_t>(-sample.batteryCurrentMA) : 0;
+
+    // Smoothed currents; restarted whenever the phase changes so old regimes don't leak in
+    if (phase != lastPhase_ || chargeAvgX16_ == 0) {
+        chargeAvgX16_ = static_cast<uint32_t>(chargeMA) * 16;
+    } else {
+        chargeAvgX16_ = chargeAvgX16_ - chargeAvgX16_ / 4 + static_cast<uint32_t>(chargeMA) * 4;
+    }
+    if (phase == BQ25895ChargePhase::DISCHARGING) {
+        if (lastPhase_ != BQ25895ChargePhase::DISCHARGING || dischargeAvgX16_ == 0) {
+            dischargeAvgX16_ = static_cast<uint32_t>(dischargeMA) * 16;
+        } else {
+            dischargeAvgX16_ = dischargeAvgX16_ - dischargeAvgX16_ / 8 + static_cast<uint32_t>(dischargeMA) * 2;
+        }
+    }
+
+    if (phase == BQ25895ChargePhase::CONSTANT_VOLTAGE) {
+        if (lastPhase_ != BQ25895ChargePhase::CONSTANT_VOLTAGE) {
+            // CC->CV: remember how much charge CV had left to deliver
+            if (lastPhase_ == BQ25895ChargePhase::CONSTANT_CURRENT &&
+                sample.capacityMAh > sample.remainingMAh) {
+                uint16_t observed = sample.capacityMAh - sample.remainingMAh;
+                cvChargeMAh_ = cvChargeMAh_ ? static_cast<uint16_t>((cvChargeMAh_ + observed) / 2) : observed;
+            }
+            cvStartMA_ = chargeMA;
+            cvStartTime_ = sample.timestamp;
+        } else if (chargeMA > 0 && static_cast<uint32_t>(chargeMA) * 5 <= static_cast<uint32_t>(cvStartMA_) * 4) {
+            // Fit I = I0 * exp(-t / tau) once the current has fallen at least 20%
+            float decay = logf(static_cast<float>(cvStartMA_) / chargeMA);
+            tauS_ = static_cast<uint32_t>((sample.timestamp - cvStartTime_) / 1000.0f / decay);
+        }
+    }
+
+    prediction_.phase = phase;
+    prediction_.averageChargeMA = static_cast<uint16_t>(chargeAvgX16_ / 16);
+    prediction_.averageDischargeMA = static_cast<uint16_t>(dischargeAvgX16_ / 16);
+
+    prediction_.timeToFullS = predictFull(sample, phase);
+    prediction_.fullValid = phase == BQ25895ChargePhase::DONE ||
+                            (sample.capacityMAh > 0 && prediction_.timeToFullS > 0);
+
+    prediction_.emptyValid = phase == BQ25895ChargePhase::DISCHARGING && sample.capacityMAh > 0 &&
+                             prediction_.averageDischargeMA > 0;
+    prediction_.timeToEmptyS = prediction_.emptyValid
+        ? static_cast<uint32_t>(sample.remainingMAh) * 3600 / prediction_.averageDischargeMA : 0;
+
+    lastPhase_ = phase;
+}
+
+uint32_t BQ25895ChargePredictor::predictFull(const BQ25895PredictorSample& sample, BQ25895ChargePhase phase) {
+    if (sample.capacityMAh == 0 || phase == BQ25895ChargePhase::DONE ||
+        phase == BQ25895ChargePhase::IDLE || phase == BQ25895ChargePhase::DISCHARGING) {
+        return 0;
+    }
+
+    uint32_t remainingToFull = sample.capacityMAh > sample.remainingMAh ? sample.capacityMAh - sample.remainingMAh : 0;
+    uint16_t iterm = sample.terminationMA ? sample.terminationMA : 1;
+    uint16_t current = prediction_.averageChargeMA;
+
+    if (phase == BQ25895ChargePhase::CONSTANT_VOLTAGE) {
+        // CV current falls steadily; the smoothed value would lag behind it
+        current = sample.batteryCurrentMA > 0 ? static_cast<uint16_t>(sample.batteryCurrentMA) : 0;
+        if (current <= iterm) {
+            return 1; // Termination is imminent
+        }
+        // Without a fitted tau, size the decay so it delivers exactly what is left
+        float tau = tauS_ ? static_cast<float>(tauS_) : remainingToFull * 3600.0f / (current - iterm);
+        return static_cast<uint32_t>(tau * logf(static_cast<float>(current) / iterm)) + 1;
+    }
+
+    // Pre-charge ends at the configured fast-charge current
+    uint16_t ccCurrent = (phase == BQ25895ChargePhase::PRE_CHARGE || current == 0) ? sample.chargeCurrentMA : current;
+    if (ccCurrent <= iterm) {
+        return 0;
+    }
+
+    // Until a CC->CV transition has been seen, assume CV delivers the last 15% of capacity
+    uint32_t cvCharge = cvChargeMAh_ ? cvChargeMAh_ : static_cast<uint32_t>(sample.capacityMAh) * 3 / 20;
+    if (cvCharge > remainingToFull) {
+        cvCharge = remainingToFull;
+    }
+    uint32_t ccTime = (remainingToFull - cvCharge) * 3600 / ccCurrent;
+    float tau = tauS_ ? static_cast<float>(tauS_) : cvCharge * 3600.0f / (ccCurrent - iterm);
+    return ccTime + static_cast<uint32_t>(tau * logf(static_cast<float>(ccCurrent) / iterm)) + 1;
+}
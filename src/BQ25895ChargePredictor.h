@@ -0,0 +1,72 @@
+#ifndef BQ25895_CHARGE_PREDICTOR_H
+#define BQ25895_CHARGE_PREDICTOR_H
+
+#include <stdint.h>
+
+// REG0B CHRG_STAT values (ChargeStatus) as carried in predictor and session samples
+#define BQ25895_CHRG_STAT_PRE_CHARGE 1
+#define BQ25895_CHRG_STAT_FAST_CHARGE 2
+#define BQ25895_CHRG_STAT_TERMINATED 3
+
+// Charge phase as seen by the predictor (the BQ25895 reports CC and CV both as fast charge)
+enum class BQ25895ChargePhase : uint8_t {
+  IDLE = 0,              // External power, not charging
+  PRE_CHARGE = 1,
+  CONSTANT_CURRENT = 2,
+  CONSTANT_VOLTAGE = 3,
+  DONE = 4,              // Charge terminated
+  DISCHARGING = 5        // Running on battery
+};
+
+struct BQ25895TimePrediction {
+  BQ25895ChargePhase phase = BQ25895ChargePhase::IDLE;
+  bool fullValid = false;
+  bool emptyValid = false;
+  uint32_t timeToFullS = 0;
+  uint32_t timeToEmptyS = 0;
+  uint16_t averageChargeMA = 0;     // Smoothed ICHGR
+  uint16_t averageDischargeMA = 0;  // Smoothed discharge current
+};
+
+// One sample of everything the predictor needs, assembled by the driver per getMetrics()
+struct BQ25895PredictorSample {
+  uint32_t timestamp = 0;
+  uint8_t chargeStatus = 0;         // ChargeStatus (REG0B CHRG_STAT)
+  bool externalPower = false;
+  uint16_t batteryMV = 0;
+  int16_t batteryCurrentMA = 0;     // + charging, - discharging
+  uint16_t remainingMAh = 0;
+  uint16_t capacityMAh = 0;
+  uint16_t chargeVoltageMV = 0;     // VREG target
+  uint16_t chargeCurrentMA = 0;     // ICHG setting (fast-charge current)
+  uint16_t terminationMA = 0;       // ITERM
+};
+
+// Incremental time-to-full/time-to-empty predictor. CC time comes from the charge still
+// to deliver before CV; CV time follows an exponential current decay toward ITERM whose
+// time constant is learned while in CV. Fixed memory, O(1) per sample.
+class BQ25895ChargePredictor {
+public:
+  void reset();
+  void update(const BQ25895PredictorSample& sample);
+  BQ25895TimePrediction prediction() const { return prediction_; }
+
+  uint16_t learnedCvChargeMAh() const { return cvChargeMAh_; }
+
+  // Battery within one BATV step (20mV) of VREG counts as CV
+  static const uint16_t kCvMarginMV = 20;
+
+private:
+  uint32_t predictFull(const BQ25895PredictorSample& sample, BQ25895ChargePhase phase);
+
+  BQ25895TimePrediction prediction_;
+  BQ25895ChargePhase lastPhase_ = BQ25895ChargePhase::IDLE;
+  uint32_t chargeAvgX16_ = 0;       // EMA, 1/4 weight, mA * 16
+  uint32_t dischargeAvgX16_ = 0;    // EMA, 1/8 weight, mA * 16
+  uint16_t cvChargeMAh_ = 0;        // Charge delivered in CV, learned at each CC->CV transition
+  uint16_t cvStartMA_ = 0;          // First CV sample, for the time-constant fit
+  uint32_t cvStartTime_ = 0;
+  uint32_t tauS_ = 0;               // Learned CV time constant (0 = not yet known)
+};
+
+#endif // BQ25895_CHARGE_PREDICTOR_H
@@ -1,25 +1,20 @@
 #include "BQ25895Driver.h"
+#include "BQ25895Log.h"
 
 #if defined(ARDUINO)
-// Arduino-specific time function
+// Arduino-specific time functions
 unsigned long millis();
+unsigned long micros();
 #else
 // Mock time functions for testing (defined in test files)
 extern unsigned long mock_millis;
 extern unsigned long millis();
+extern unsigned long micros();
 #endif
 
 #if defined(ARDUINO)
 #include <Arduino.h>
 #include <math.h>
-#define DEBUG_PRINT(x) Serial.print(x)
-#define DEBUG_PRINTLN(x) Serial.println(x)
-// Portable printf for Arduino platforms - some don't have Serial.printf
-#define DEBUG_PRINTF(fmt, ...) do { \
-    char debug_buffer[256]; \
-    snprintf(debug_buffer, sizeof(debug_buffer), fmt, __VA_ARGS__); \
-    Serial.print(debug_buffer); \
-} while(0)
 #define PLATFORM_DELAY(ms) delay(ms)
 #define HEX 16
 #else
@@ -27,9 +22,6 @@ extern unsigned long millis();
 #include <cmath>
 #include <thread>
 #include <chrono>
-#define DEBUG_PRINT(x) printf("%s", String(x).c_str())
-#define DEBUG_PRINTLN(x) printf("%s\n", String(x).c_str())
-#define DEBUG_PRINTF(fmt, ...) printf(fmt, __VA_ARGS__)
 #define PLATFORM_DELAY(ms) std::this_thread::sleep_for(std::chrono::milliseconds(ms))
 #define HEX 16
 #endif
@@ -41,8 +33,20 @@ BQ25895Driver::BQ25895Driver(Adafruit_I2CDevice* i2c_dev) : i2c_dev_(i2c_dev) {
     }
 }
 
+// Out-of-line definitions for ODR-used static constexpr members (C++11)
+constexpr uint8_t BQ25895RegisterImage::kBurstStart;
+constexpr uint8_t BQ25895RegisterImage::kBurstLength;
+
 // Initialization and configuration
 bool BQ25895Driver::initialize(const BQ25895Config& config) {
+    // Runtime configurations are compiled with the same constexpr encoders as the presets
+    return initialize(config, BQ25895RegisterImage::compile(config));
+}
+
+bool BQ25895Driver::initialize(const BQ25895Config& config, const BQ25895RegisterImage& image) {
+    unsigned long startUs = micros();
+    uint16_t startTransactions = busTransactions_;
+    
     if (!i2c_dev_) {
         setError("I2C device not available");
         return false;
@@ -55,11 +59,12 @@ bool BQ25895Driver::initialize(const BQ25895Config& config) {
     }
     
     config_ = config;
+    image_ = image;
     initialized_ = false;
     emergencyMode_ = false;
     lastError_ = "";
     
-    DEBUG_PRINTLN("=== BQ25895 Initialization ===");
+    BQ25895_LOGI(BQ25895_LOG_INIT, "=== BQ25895 Initialization ===");
     
     // Step 1: Verify device communication
     if (!verifyDevice()) {
@@ -67,75 +72,88 @@ bool BQ25895Driver::initialize(const BQ25895Config& config) {
         return false;
     }
     
-    // Step 2: Clear any existing faults (mark as initialized temporarily for this operation)
-    initialized_ = true;
-    clearFaults();
-    
-    // Step 3: Disable watchdog timer if requested
-    if (config_.disableWatchdog) {
-        if (!updateRegisterBits(REG07_MISC_OPERATION, WATCHDOG_MASK, WATCHDOG_DISABLE << WATCHDOG_SHIFT)) {
-            setError("Failed to disable watchdog timer");
-            initialized_ = false;
-            return false;
-        }
-        DEBUG_PRINTLN("Watchdog timer disabled");
-    }
-    
-    // Step 4: Disable safety timer if requested
-    if (config_.disableSafetyTimer) {
-        if (!updateRegisterBits(REG05_TIMER, 0x08, 0x08)) {
-            setError("Failed to disable safety timer");
-            initialized_ = false;
-            return false;
-        }
-        DEBUG_PRINTLN("Safety timer disabled");
+    // Step 2: Read (and thereby clear) any latched faults
+    uint8_t faultReg;
+    if (readFaults(faultReg) && faultReg != 0) {
+        BQ25895_LOGD(BQ25895_LOG_INIT, "Cleared latched faults at init: 0x%02X", faultReg);
     }
     
-    // Step 5: Configure VINDPM threshold
-    uint8_t vindpmReg = 0x80; // Force VINDPM enabled
-    vindpmReg |= ((config_.vindpmThresholdMV - 2600) / 100) & 0x0F;
-    if (!writeRegisterWithRetry(REG0D_VINDPM, vindpmReg)) {
-        setError("Failed to set VINDPM threshold");
-        initialized_ = false;
+    // Step 3: Program REG00-REG07 (input/charge current, voltage, termination,
+    // watchdog and safety timer) as one pre-built burst
+    if (!writeRegisterImage(image)) {
+        setError("Failed to write configuration registers");
         return false;
     }
-    DEBUG_PRINTF("Set VINDPM threshold to %dmV\n", config_.vindpmThresholdMV);
+    BQ25895_LOGD(BQ25895_LOG_INIT, "Configuration written: IINLIM=0x%02X ICHG=0x%02X VREG=0x%02X REG07=0x%02X",
+                 image.burst[REG00_INPUT_CURRENT], image.burst[REG04_CHARGE_CURRENT],
+                 image.burst[REG06_CHARGE_VOLTAGE], image.burst[REG07_MISC_OPERATION]);
     
-    // Step 6: Set input current limit (driver is now marked as initialized)
-    if (!setInputCurrentLimit(config_.inputCurrentMA)) {
-        setError("Failed to set input current limit");
-        initialized_ = false;
-        return false;
+    // Initialization successful
+    initialized_ = true;
+    initReport_.startType = BQ25895StartType::COLD;
+    initReport_.registersReprogrammed = BQ25895RegisterImage::kBurstLength + 1;
+    initReport_.busTransactions = busTransactions_ - startTransactions;
+    initReport_.durationUs = micros() - startUs;
+    recordEvent(BQ25895EventCode::INIT, static_cast<uint8_t>(BQ25895StartType::COLD));
+    BQ25895_LOGI(BQ25895_LOG_INIT, "BQ25895 initialization complete!");
+    
+    return true;
+}
+
+bool BQ25895Driver::warmStart(const BQ25895Config& config) {
+    return warmStart(config, BQ25895RegisterImage::compile(config));
+}
+
+bool BQ25895Driver::warmStart(const BQ25895Config& config, const BQ25895RegisterImage& image) {
+    unsigned long startUs = micros();
+    uint16_t startTransactions = busTransactions_;
+    
+    if (!i2c_dev_ || !i2c_dev_->begin()) {
+        return initialize(config, image); // Cold path reports the error
     }
     
-    // Step 7: Set charge current
-    if (!setChargeCurrent(config_.chargeCurrentMA)) {
-        setError("Failed to set charge current");
-        initialized_ = false;
-        return false;
+    // One burst covers the configuration (REG00-REG07), the part ID (REG0A) and
+    // status (REG0B); REG0C is excluded because it does not support multi-read
+    uint8_t snapshot[12];
+    uint8_t vindpm;
+    if (!readRegisterBurst(REG00_INPUT_CURRENT, snapshot, sizeof(snapshot)) ||
+        !readRegisterWithRetry(REG0D_VINDPM, vindpm)) {
+        BQ25895_LOGW(BQ25895_LOG_INIT, "Warm start snapshot failed - falling back to cold start");
+        return initialize(config, image);
     }
     
-    // Step 8: Set charge voltage
-    if (!setChargeVoltage(config_.chargeVoltageNV)) {
-        setError("Failed to set charge voltage");
-        initialized_ = false;
-        return false;
+    uint8_t vendorId = (snapshot[REG0A_VENDOR_PART] >> 3) & 0x1F;
+    if (vendorId == 0 || vendorId == 0x1F) {
+        return initialize(config, image);
     }
     
-    // Step 9: Set termination current
-    if (!setTerminationCurrent(config_.terminationCurrentMA)) {
-        setError("Failed to set termination current");
-        initialized_ = false;
+    config_ = config;
+    image_ = image;
+    emergencyMode_ = false;
+    lastError_ = "";
+    
+    // Reprogram only the registers that diverge from the image
+    uint8_t diverged;
+    uint16_t divergedMask;
+    if (!reconcileImage(snapshot, vindpm, true, diverged, divergedMask)) {
         return false;
     }
     
-    // Initialization successful
     initialized_ = true;
-    DEBUG_PRINTLN("BQ25895 initialization complete!");
+    initReport_.startType = BQ25895StartType::WARM;
+    initReport_.registersReprogrammed = diverged;
+    initReport_.busTransactions = busTransactions_ - startTransactions;
+    initReport_.durationUs = micros() - startUs;
+    recordEvent(BQ25895EventCode::INIT, static_cast<uint8_t>(BQ25895StartType::WARM));
+    BQ25895_LOGI(BQ25895_LOG_INIT, "BQ25895 warm start complete (%d registers reprogrammed)", diverged);
     
     return true;
 }
 
+BQ25895InitReport BQ25895Driver::getInitReport() const {
+    return initReport_;
+}
+
 bool BQ25895Driver::isInitialized() const {
     return initialized_;
 }
@@ -147,24 +165,17 @@ void BQ25895Driver::reset() {
 }
 
 void BQ25895Driver::factoryReset() {
+    if (startFactoryReset()) {
+        finishProcedure();
+    }
+}
+
+bool BQ25895Driver::startFactoryReset() {
     if (!i2c_dev_) {
         setError("I2C device not available");
-        return;
+        return false;
     }
-    
-    DEBUG_PRINTLN("Performing factory reset...");
-    
-    // Send reset command
-    writeRegisterWithRetry(REG14_RESET, 0x80);
-    
-    // Wait for reset to complete (simulated delay)
-    #if defined(ARDUINO)
-    PLATFORM_DELAY(500);
-    #endif
-    
-    DEBUG_PRINTLN("Factory reset complete");
-    
-    reset(); // Mark as uninitialized
+    return startProcedure(BQ25895ProcedureId::FACTORY_RESET, 2000);
 }
 
 // Status and measurements
@@ -191,9 +202,14 @@ BQ25895Status BQ25895Driver::getStatus() {
         // Trust the IC's built-in protections and detection
     }
     
-    // Read fault register (read twice to get current status)
-    readRegisterWithRetry(REG0C_FAULT, value); // Clear latched faults
-    if (readRegisterWithRetry(REG0C_FAULT, value)) {
+    if (oscillationPending_) {
+        oscillationPending_ = false;
+        mitigateOscillation();
+    }
+    checkOscillationDetach();
+    
+    // Read fault register once; latched bits are kept by the fault accumulator
+    if (readFaults(value)) {
         status.faultRegister = value;
         status.watchdogFault = (value & 0x80) != 0;
         status.chargeFault = (value & 0x30) != 0;
@@ -214,8 +230,9 @@ BQ25895Metrics BQ25895Driver::getMetrics() {
         return metrics;
     }
     
-    // Start ADC conversion
-    writeRegisterWithRetry(0x02, 0x80);
+    // Start ADC conversion (keeping the configured REG02 features such as ICO_EN)
+    writeRegisterWithRetry(REG02_ADC_CONTROL, image_.value(REG02_ADC_CONTROL) | REG02_CONV_START);
+    sampleCached_ = 0;
     
     #if defined(ARDUINO)
     PLATFORM_DELAY(20); // Wait for conversion
@@ -226,6 +243,7 @@ BQ25895Metrics BQ25895Driver::getMetrics() {
     // Read battery voltage (REG0E)
     if (readRegisterWithRetry(REG0E_BATV, value)) {
         metrics.batteryVoltage = 2304 + (value & 0x7F) * 20; // mV
+        metrics.thermalRegulation = (value & 0x80) != 0;     // THERM_STAT
     }
     
     // Read system voltage (REG0F)
@@ -249,6 +267,15 @@ BQ25895Metrics BQ25895Driver::getMetrics() {
         metrics.tsVoltage = (uint16_t)((5000.0 * (value & 0x7F)) / 127.0);
     }
     
+    updateBrownoutPredictor(metrics);
+    updateAnalytics(metrics);
+    updateStepCharging(metrics);
+    updateTemperatureZones(metrics);
+    updatePowerBudget(metrics);
+    updateVindpmTracking(metrics);
+    updateThermalGovernor(metrics);
+    updatePowerFlow(metrics);
+    
     return metrics;
 }
 
@@ -256,6 +283,712 @@ void BQ25895Driver::updateAll() {
     // Updates both status and metrics (for future caching implementation)
     getStatus();
     getMetrics();
+    tick();
+    pollDriftMonitor();
+    pollInputCurrentOptimization();
+    pollHighVoltageNegotiation();
+    
+    // Idle-time log output (no-op unless the buffered sinks are in use)
+    BQ25895Log::drain();
+}
+
+void BQ25895Driver::updateBrownoutPredictor(const BQ25895Metrics& metrics) {
+    if (!brownout_.update(metrics.timestamp, metrics.systemVoltage, metrics.batteryVoltage)) {
+        return;
+    }
+    BQ25895BrownoutState state = brownout_.state();
+    uint32_t seconds = state.timeToThresholdMs / 1000;
+    BQ25895_LOGW(BQ25895_LOG_POWER, "Brownout warning: VSYS %umV falling %ldmV/s, %lums to threshold",
+                 metrics.systemVoltage, (long)state.slopeMVPerS, (unsigned long)state.timeToThresholdMs);
+    recordEvent(BQ25895EventCode::BROWNOUT_WARNING, static_cast<uint8_t>(seconds < 255 ? seconds : 255));
+}
+
+// Per-sample analytics (SoC, predictions, health, sessions), fed by getMetrics()
+void BQ25895Driver::updateAnalytics(const BQ25895Metrics& metrics) {
+    uint8_t value;
+    if ((!soc_.enabled() && !sessions_.enabled()) || metrics.batteryVoltage == 0 ||
+        !readSampleRegister(REG0B_SYSTEM_STATUS, value)) {
+        return;
+    }
+    
+    // Input presence and charge phase come from REG0B
+    bool externalPower = inputPowered(value);
+    uint8_t chargeStat = (value >> 3) & 0x03;
+    bool terminated = chargeStat == static_cast<uint8_t>(ChargeStatus::CHARGE_TERMINATION);
+    
+    // Charge targets come from the register image, so setter changes are picked up
+    uint16_t chargeVoltageMV = 3840 + (image_.value(REG06_CHARGE_VOLTAGE) >> 2) * 16;
+    
+    if (soc_.enabled()) {
+        soc_.update(metrics.timestamp, metrics.batteryVoltage, metrics.chargeCurrentMA,
+                    externalPower, terminated);
+        
+        BQ25895SocState soc = soc_.state();
+        BQ25895PredictorSample sample;
+        sample.timestamp = metrics.timestamp;
+        sample.chargeStatus = chargeStat;
+        sample.externalPower = externalPower;
+        sample.batteryMV = metrics.batteryVoltage;
+        sample.batteryCurrentMA = soc.batteryCurrentMA;
+        sample.remainingMAh = soc.remainingMAh;
+        sample.capacityMAh = soc_.config().capacityMAh;
+        sample.chargeVoltageMV = chargeVoltageMV;
+        sample.chargeCurrentMA = (image_.value(REG04_CHARGE_CURRENT) & 0x7F) * 64;
+        sample.terminationMA = 64 + (image_.value(REG05_TIMER) & 0x0F) * 64;
+        predictor_.update(sample);
+        
+        bool charging = externalPower && (chargeStat == static_cast<uint8_t>(ChargeStatus::PRE_CHARGE) ||
+                                          chargeStat == static_cast<uint8_t>(ChargeStatus::FAST_CHARGE));
+        health_.update(metrics.timestamp, metrics.batteryVoltage, soc.batteryCurrentMA, charging,
+                       terminated, soc.socPermille, soc.confidence >= BQ25895_SOC_CONFIDENCE_REST);
+    }
+    
+    if (sessions_.enabled()) {
+        BQ25895SessionSample sample;
+        sample.timestamp = metrics.timestamp;
+        sample.externalPower = externalPower;
+        sample.chargeStatus = chargeStat;
+        sample.batteryMV = metrics.batteryVoltage;
+        sample.chargeMA = metrics.chargeCurrentMA;
+        sample.tsVoltage = metrics.tsVoltage;
+        sample.chargeVoltageMV = chargeVoltageMV;
+        // REG0B has no DPM flag on the BQ25895; REG13 reports both regulation loops
+        if (readSampleRegister(REG13_VDPMSTAT, value)) {
+            sample.vindpm = (value & REG13_VDPM_STAT) != 0;
+            sample.iindpm = (value & REG13_IDPM_STAT) != 0;
+        }
+        sessions_.update(sample);
+    }
+}
+
+void BQ25895Driver::updateStepCharging(const BQ25895Metrics& metrics) {
+    if (!stepProfile_.update(metrics.batteryVoltage)) {
+        return;
+    }
+    
+    const BQ25895ChargeStage& stage = stepProfile_.current();
+    BQ25895_LOGI(BQ25895_LOG_POWER, "Step charging: stage %u at %umV (ICHG %umA, VREG %umV)",
+                 stepProfile_.stage(), metrics.batteryVoltage, stage.chargeCurrentMA, stage.chargeVoltageMV);
+    stepState_.stage = stepProfile_.stage();
+    stepState_.chargeCurrentMA = stage.chargeCurrentMA;
+    stepState_.chargeVoltageMV = stage.chargeVoltageMV;
+    if (applyChargeTargets()) {
+        stepState_.transitions++;
+        stepState_.lastTransition = metrics.timestamp;
+    }
+}
+
+void BQ25895Driver::updateTemperatureZones(const BQ25895Metrics& metrics) {
+    // NTC_FAULT reflects the live TS comparators; the last REG0C poll is recent enough
+    if (!zones_.update(metrics.tsVoltage, faults_.lastRaw)) {
+        return;
+    }
+    BQ25895_LOGI(BQ25895_LOG_SAFETY, "Temperature zone %u at TS %umV (ICHG %u%%, VREG cap %umV)",
+                 static_cast<uint8_t>(zones_.rule().zone), metrics.tsVoltage, zones_.rule().chargePercent,
+                 zones_.rule().chargeVoltageMV);
+    applyChargeTargets();
+}
+
+void BQ25895Driver::updatePowerBudget(const BQ25895Metrics& metrics) {
+    uint8_t value;
+    if (!budget_.enabled() || metrics.batteryVoltage == 0 ||
+        !readSampleRegister(REG0B_SYSTEM_STATUS, value)) {
+        return;
+    }
+    
+    BQ25895PowerSample sample;
+    sample.externalPower = inputPowered(value);
+    sample.inputMV = metrics.inputVoltage;
+    sample.systemMV = metrics.systemVoltage;
+    sample.batteryMV = metrics.batteryVoltage;
+    uint16_t voltageMV;
+    chargeDemand(sample.chargeDemandMA, voltageMV);
+    
+    // A raised IINLIM belongs to this adapter only
+    if (!sample.externalPower && budgetRaisedInput_) {
+        restoreBudgetInputLimit();
+    }
+    sample.inputLimitMA = 100 + (image_.value(REG00_INPUT_CURRENT) & 0x3F) * 50;
+    
+    bool changed = budget_.update(sample);
+    if (budget_.inputLimitRequestMA() != 0) {
+        if (!budgetRaisedInput_) {
+            budgetSavedInput_ = image_.value(REG00_INPUT_CURRENT);
+        }
+        BQ25895_LOGI(BQ25895_LOG_POWER, "Power budget: IINLIM %umA -> %umA for a %lumW load",
+                     sample.inputLimitMA, budget_.inputLimitRequestMA(), (unsigned long)budget_.load());
+        if (setInputCurrentLimit(budget_.inputLimitRequestMA())) {
+            budgetRaisedInput_ = true;
+            sample.inputLimitMA = 100 + (image_.value(REG00_INPUT_CURRENT) & 0x3F) * 50;
+            changed = budget_.update(sample) || changed;
+        }
+    }
+    
+    if (changed) {
+        BQ25895_LOGI(BQ25895_LOG_POWER, "Power budget: ICHG limit %umA (load %lumW, input %lumW)",
+                     budget_.chargeLimitMA(), (unsigned long)budget_.load(),
+                     (unsigned long)budget_.budget().inputMW);
+        applyChargeTargets();
+    }
+}
+
+void BQ25895Driver::updateVindpmTracking(const BQ25895Metrics& metrics) {
+    uint8_t value;
+    if (!vindpm_.enabled() || !readSampleRegister(REG0B_SYSTEM_STATUS, value)) {
+        return;
+    }
+    
+    bool attached = inputPowered(value);
+    uint16_t programmedMV = 2600 + (image_.value(REG0D_VINDPM) & 0x7F) * 100;
+    if (!attached) {
+        // The next adapter starts from the ceiling again
+        if (vindpmAttached_ && programmedMV != vindpm_.ceilingMV()) {
+            writeRegisterWithRetry(REG0D_VINDPM, 0x80 | BQ25895Encode::vindpm(vindpm_.ceilingMV()));
+        }
+        vindpmAttached_ = false;
+        return;
+    }
+    if (hv_.state == BQ25895HvState::NEGOTIATING) {
+        return;
+    }
+    // New adapter, or VINDPM retuned elsewhere (HV negotiation, oscillation mitigation)
+    if (!vindpmAttached_ || programmedMV != vindpm_.vindpmMV()) {
+        vindpm_.rebase(programmedMV);
+        vindpmAttached_ = true;
+    }
+    
+    if (!readSampleRegister(REG13_VDPMSTAT, value)) {
+        return;
+    }
+    uint16_t nextMV;
+    uint16_t chargeMA = metrics.chargeCurrentMA > 0 ? static_cast<uint16_t>(metrics.chargeCurrentMA) : 0;
+    if (!vindpm_.update(metrics.timestamp, metrics.inputVoltage, metrics.batteryVoltage, chargeMA,
+                        (value & REG13_VDPM_STAT) != 0, (value & REG13_IDPM_STAT) != 0, nextMV)) {
+        return;
+    }
+    BQ25895_LOGI(BQ25895_LOG_POWER, "VINDPM tracking: %umV -> %umV (VBUS %umV, %lumW)",
+                 programmedMV, nextMV, metrics.inputVoltage, (unsigned long)vindpm_.state().chargePowerMW);
+    if (!writeRegisterWithRetry(REG0D_VINDPM, 0x80 | BQ25895Encode::vindpm(nextMV))) {
+        vindpm_.rebase(programmedMV);
+    }
+}
+
+void BQ25895Driver::updatePowerFlow(const BQ25895Metrics& metrics) {
+    uint8_t reg0B;
+    uint8_t reg13;
+    if (!powerFlow_.enabled() || metrics.batteryVoltage == 0 ||
+        !readSampleRegister(REG0B_SYSTEM_STATUS, reg0B) || !readSampleRegister(REG13_VDPMSTAT, reg13)) {
+        return;
+    }
+    
+    BQ25895PowerFlowSample sample;
+    sample.externalPower = inputPowered(reg0B);
+    sample.inputMV = metrics.inputVoltage;
+    sample.batteryMV = metrics.batteryVoltage;
+    sample.chargeMA = metrics.chargeCurrentMA > 0 ? static_cast<uint16_t>(metrics.chargeCurrentMA) : 0;
+    // IDPM_LIM is the limit in force (after ICO), not necessarily the programmed IINLIM
+    sample.inputLimitMA = 100 + (reg13 & REG13_IDPM_LIM_MASK) * 50;
+    sample.vindpm = (reg13 & REG13_VDPM_STAT) != 0;
+    sample.iindpm = (reg13 & REG13_IDPM_STAT) != 0;
+    sample.declaredLoadMW = budget_.load();
+    sample.dischargeMA = soc_.loadCurrent();
+    powerFlow_.update(sample);
+}
+
+// An adapter is attached and not suspended by the power path
+bool BQ25895Driver::inputPowered(uint8_t reg0B) const {
+    uint8_t vbusStat = (reg0B & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT;
+    return vbusStat != static_cast<uint8_t>(VBusType::NONE) &&
+           vbusStat != static_cast<uint8_t>(VBusType::OTG) &&
+           (image_.value(REG00_INPUT_CURRENT) & REG00_EN_HIZ) == 0;
+}
+
+// REG0B and REG13 are read at most once per getMetrics() sample, however many consumers need them
+bool BQ25895Driver::readSampleRegister(uint8_t reg, uint8_t& value) {
+    uint8_t bit = reg == REG0B_SYSTEM_STATUS ? 0x01 : 0x02;
+    uint8_t& cached = reg == REG0B_SYSTEM_STATUS ? sampleReg0B_ : sampleReg13_;
+    if ((sampleCached_ & bit) == 0) {
+        if (!readRegisterWithRetry(reg, cached)) {
+            return false;
+        }
+        sampleCached_ |= bit;
+    }
+    value = cached;
+    return true;
+}
+
+void BQ25895Driver::restoreBudgetInputLimit() {
+    // Only IINLIM is restored; EN_HIZ/EN_ILIM may have changed since
+    uint8_t reg00 = (image_.value(REG00_INPUT_CURRENT) & 0xC0) | (budgetSavedInput_ & 0x3F);
+    if (writeRegisterWithRetry(REG00_INPUT_CURRENT, reg00)) {
+        budgetRaisedInput_ = false;
+    }
+}
+
+// Charge target arbitration: base (or step stage) -> temperature zone cap -> power budget
+// -> thermal governor
+bool BQ25895Driver::chargePoliciesActive() const {
+    return stepProfile_.active() || zones_.enabled() || budget_.rebalancing() || thermal_.enabled();
+}
+
+void BQ25895Driver::captureChargeBase() {
+    if (!chargeBaseCaptured_) {
+        chargeBaseCurrentMA_ = (image_.value(REG04_CHARGE_CURRENT) & 0x7F) * 64;
+        chargeBaseVoltageMV_ = 3840 + (image_.value(REG06_CHARGE_VOLTAGE) >> 2) * 16;
+        chargeBaseCaptured_ = true;
+    }
+}
+
+void BQ25895Driver::chargeDemand(uint16_t& currentMA, uint16_t& voltageMV) const {
+    if (!chargeBaseCaptured_) {
+        currentMA = (image_.value(REG04_CHARGE_CURRENT) & 0x7F) * 64;
+        voltageMV = 3840 + (image_.value(REG06_CHARGE_VOLTAGE) >> 2) * 16;
+        return;
+    }
+    currentMA = chargeBaseCurrentMA_;
+    voltageMV = chargeBaseVoltageMV_;
+    if (stepProfile_.active()) {
+        currentMA = stepProfile_.current().chargeCurrentMA;
+        voltageMV = stepProfile_.current().chargeVoltageMV;
+    }
+    if (zones_.enabled()) {
+        const BQ25895TempZoneRule& rule = zones_.rule();
+        currentMA = static_cast<uint16_t>(static_cast<uint32_t>(currentMA) * rule.chargePercent / 100);
+        if (rule.chargeVoltageMV != 0 && rule.chargeVoltageMV < voltageMV) {
+            voltageMV = rule.chargeVoltageMV;
+        }
+    }
+}
+
+void BQ25895Driver::chargeTargetCeiling(uint16_t& currentMA, uint16_t& voltageMV) const {
+    chargeDemand(currentMA, voltageMV);
+    if (budget_.rebalancing() && budget_.chargeLimitMA() != 0 && budget_.chargeLimitMA() < currentMA) {
+        currentMA = budget_.chargeLimitMA();
+    }
+}
+
+bool BQ25895Driver::applyChargeTargets() {
+    uint16_t currentMA;
+    uint16_t voltageMV;
+    chargeTargetCeiling(currentMA, voltageMV);
+    if (thermal_.enabled()) {
+        thermal_.setCeiling(currentMA);
+        currentMA = thermal_.setpointMA();
+    }
+    return writeChargeTargets(currentMA, voltageMV);
+}
+
+// ICHG (REG04) and VREG (REG06) in one transaction: a single register when only one
+// changes, otherwise a REG04-REG06 burst that rewrites REG05 from the image
+bool BQ25895Driver::writeChargeTargets(uint16_t currentMA, uint16_t voltageMV) {
+    uint8_t values[3] = {
+        static_cast<uint8_t>((image_.value(REG04_CHARGE_CURRENT) & REG04_EN_PUMPX) |
+                             BQ25895Encode::chargeCurrent(currentMA)),
+        image_.value(REG05_TIMER),
+        static_cast<uint8_t>((BQ25895Encode::chargeVoltage(voltageMV) << 2) |
+                             (image_.value(REG06_CHARGE_VOLTAGE) & 0x03))
+    };
+    bool currentChanged = values[0] != image_.value(REG04_CHARGE_CURRENT);
+    bool voltageChanged = values[2] != image_.value(REG06_CHARGE_VOLTAGE);
+    
+    if (currentChanged && voltageChanged) {
+        return writeRegisterBurst(REG04_CHARGE_CURRENT, values, 3);
+    } else if (currentChanged) {
+        return writeRegisterWithRetry(REG04_CHARGE_CURRENT, values[0]);
+    } else if (voltageChanged) {
+        return writeRegisterWithRetry(REG06_CHARGE_VOLTAGE, values[2]);
+    }
+    return true;
+}
+
+void BQ25895Driver::updateThermalGovernor(const BQ25895Metrics& metrics) {
+    uint16_t setpointMA;
+    if (!thermal_.update(metrics.timestamp, metrics.chargeCurrentMA > 0, metrics.thermalRegulation,
+                         metrics.tsVoltage, setpointMA)) {
+        return;
+    }
+    BQ25895_LOGD(BQ25895_LOG_POWER, "Thermal governor: ICHG %umA (THERM_STAT=%d, TS=%umV)",
+                 setpointMA, metrics.thermalRegulation ? 1 : 0, metrics.tsVoltage);
+    setChargeCurrent(setpointMA);
+}
+
+// State of charge
+void BQ25895Driver::configureSocEstimator(const BQ25895SocConfig& config) {
+    soc_.configure(config);
+    predictor_.reset();
+    
+    // Health defaults to the same design capacity until configured separately
+    BQ25895HealthConfig healthConfig;
+    healthConfig.designCapacityMAh = config.capacityMAh;
+    health_.configure(healthConfig);
+}
+
+void BQ25895Driver::setBatteryLoadCurrent(uint16_t currentMA) {
+    soc_.setLoadCurrent(currentMA);
+}
+
+BQ25895SocState BQ25895Driver::getStateOfCharge() const {
+    return soc_.state();
+}
+
+BQ25895TimePrediction BQ25895Driver::getTimePrediction() const {
+    return predictor_.prediction();
+}
+
+void BQ25895Driver::configureHealthEstimator(const BQ25895HealthConfig& config) {
+    health_.configure(config);
+}
+
+void BQ25895Driver::setHealthSaveHook(BQ25895HealthSaveHook hook) {
+    health_.setSaveHook(hook);
+}
+
+bool BQ25895Driver::restoreHealth(const BQ25895HealthRecord& record) {
+    if (!health_.restore(record)) {
+        setError("Battery health record is corrupt or from another version");
+        return false;
+    }
+    return true;
+}
+
+BQ25895HealthRecord BQ25895Driver::getHealthRecord() const {
+    return health_.record();
+}
+
+BQ25895BatteryHealth BQ25895Driver::getBatteryHealth() const {
+    return health_.health();
+}
+
+void BQ25895Driver::setSessionTracking(bool enabled) {
+    sessions_.setEnabled(enabled);
+}
+
+BQ25895ChargeSession BQ25895Driver::getChargeSession() const {
+    return sessions_.current();
+}
+
+BQ25895ChargeSession BQ25895Driver::getLastChargeSession() const {
+    return sessions_.last();
+}
+
+bool BQ25895Driver::isChargeSessionActive() const {
+    return sessions_.active();
+}
+
+// Step charging
+bool BQ25895Driver::setStepChargeProfile(const BQ25895ChargeStage* stages, uint8_t count, uint16_t hysteresisMV) {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    for (uint8_t i = 0; stages && i < count; i++) {
+        if (!BQ25895Limits::chargeCurrentValid(stages[i].chargeCurrentMA) ||
+            !BQ25895Limits::chargeVoltageValid(stages[i].chargeVoltageMV)) {
+            setError("Step charge stage out of range");
+            return false;
+        }
+    }
+    if (!stepProfile_.configure(stages, count, hysteresisMV)) {
+        setError("Step charge profile needs 1-8 stages with ascending thresholds");
+        return false;
+    }
+    
+    captureChargeBase();
+    stepState_ = BQ25895StepChargeState();
+    stepState_.active = true;
+    stepState_.stageCount = count;
+    return true;
+}
+
+bool BQ25895Driver::clearStepChargeProfile() {
+    if (!stepState_.active) {
+        return true;
+    }
+    stepProfile_.clear();
+    stepState_.active = false;
+    bool result = applyChargeTargets();
+    chargeBaseCaptured_ = chargePoliciesActive();
+    return result;
+}
+
+BQ25895StepChargeState BQ25895Driver::getStepChargeState() const {
+    return stepState_;
+}
+
+// Temperature zones
+bool BQ25895Driver::configureTemperatureZones(const BQ25895TempZoneConfig& config) {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    for (uint8_t i = 0; config.rules && i < config.ruleCount; i++) {
+        if (config.rules[i].chargeVoltageMV != 0 &&
+            !BQ25895Limits::chargeVoltageValid(config.rules[i].chargeVoltageMV)) {
+            setError("Temperature zone charge voltage out of range");
+            return false;
+        }
+    }
+    if (!zones_.configure(config)) {
+        setError("Temperature zone table needs 1-8 rules with ascending thresholds");
+        return false;
+    }
+    
+    // Boost mode NTC thresholds (REG01[7:5]); the buck window is fixed on the BQ25895
+    uint8_t reg01 = static_cast<uint8_t>((image_.value(REG01_VINDPM_OFFSET) & 0x1F) |
+                                         (static_cast<uint8_t>(config.boostHot) << 6) |
+                                         (config.boostColdMinus20C ? 0x20 : 0x00));
+    if (reg01 != image_.value(REG01_VINDPM_OFFSET) && !writeRegisterWithRetry(REG01_VINDPM_OFFSET, reg01)) {
+        zones_.disable();
+        return false;
+    }
+    captureChargeBase();
+    return true;
+}
+
+bool BQ25895Driver::disableTemperatureZones() {
+    if (!zones_.enabled()) {
+        return true;
+    }
+    zones_.disable();
+    bool result = applyChargeTargets();
+    chargeBaseCaptured_ = chargePoliciesActive();
+    return result;
+}
+
+BQ25895TempZoneState BQ25895Driver::getTemperatureZone() const {
+    return zones_.state();
+}
+
+BQ25895TempZone BQ25895Driver::decodeNtcZone(uint8_t faultReg) {
+    return BQ25895TempZones::decodeNtc(faultReg);
+}
+
+// VINDPM tracking
+bool BQ25895Driver::configureVindpmTracking(const BQ25895VindpmConfig& config) {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    uint16_t programmedMV = 2600 + (image_.value(REG0D_VINDPM) & 0x7F) * 100;
+    uint16_t ceilingMV = config.maxMV != 0 ? config.maxMV : programmedMV;
+    if (!BQ25895Limits::vindpmValid(config.minMV) || !BQ25895Limits::vindpmValid(ceilingMV) ||
+        config.minMV > ceilingMV) {
+        setError("VINDPM tracking range invalid");
+        return false;
+    }
+    vindpm_.configure(config, programmedMV);
+    vindpmAttached_ = false;
+    return true;
+}
+
+bool BQ25895Driver::disableVindpmTracking() {
+    if (!vindpm_.enabled()) {
+        return true;
+    }
+    vindpm_.disable();
+    uint16_t programmedMV = 2600 + (image_.value(REG0D_VINDPM) & 0x7F) * 100;
+    if (programmedMV == vindpm_.ceilingMV()) {
+        return true;
+    }
+    return writeRegisterWithRetry(REG0D_VINDPM, 0x80 | BQ25895Encode::vindpm(vindpm_.ceilingMV()));
+}
+
+BQ25895VindpmState BQ25895Driver::getVindpmState() const {
+    return vindpm_.state();
+}
+
+// Charge oscillation detection
+void BQ25895Driver::configureOscillationDetector(const BQ25895OscillationConfig& config) {
+    oscillation_.configure(config);
+    oscillationPending_ = false;
+}
+
+void BQ25895Driver::disableOscillationDetector() {
+    oscillation_.disable();
+    oscillationPending_ = false;
+    restoreOscillationMitigation();
+}
+
+BQ25895OscillationState BQ25895Driver::getOscillationState() const {
+    return oscillation_.state();
+}
+
+bool BQ25895Driver::isChargeOscillationDetected() const {
+    BQ25895OscillationState state = oscillation_.state();
+    return state.chargeOscillating || state.vbusOscillating;
+}
+
+void BQ25895Driver::mitigateOscillation() {
+    BQ25895OscillationState state = oscillation_.state();
+    const BQ25895OscillationConfig& config = oscillation_.config();
+    BQ25895_LOGW(BQ25895_LOG_POWER, "Oscillation: %u charge / %u VBUS transitions in %lums",
+                 state.chargeTransitions, state.vbusTransitions, (unsigned long)config.windowMs);
+    if (!config.mitigate) {
+        return;
+    }
+    
+    bool changed = false;
+    if (state.chargeOscillating) {
+        // Terminating earlier stops the terminate/recharge cycle under a steady system load
+        uint8_t reg05 = image_.value(REG05_TIMER);
+        uint16_t terminationMA = 64 + (reg05 & 0x0F) * 64;
+        uint16_t next = terminationMA + config.terminationStepMA;
+        next = next < config.maxTerminationMA ? next : config.maxTerminationMA;
+        if (next > terminationMA &&
+            writeRegisterWithRetry(REG05_TIMER, (reg05 & 0xF0) | BQ25895Encode::terminationCurrent(next))) {
+            BQ25895_LOGI(BQ25895_LOG_POWER, "Oscillation: ITERM %umA -> %umA", terminationMA, next);
+            if (!oscillationRaisedTermination_) {
+                oscillationSavedReg05_ = reg05;
+                oscillationRaisedTermination_ = true;
+            }
+            changed = true;
+        }
+    }
+    if (state.vbusOscillating) {
+        // A higher VINDPM backs the input current off before a weak adapter collapses
+        uint8_t reg0D = image_.value(REG0D_VINDPM);
+        uint16_t vindpmMV = 2600 + (reg0D & 0x7F) * 100;
+        uint16_t next = vindpmMV + config.vindpmStepMV;
+        next = next < config.maxVindpmMV ? next : config.maxVindpmMV;
+        if (next > vindpmMV && writeRegisterWithRetry(REG0D_VINDPM, 0x80 | BQ25895Encode::vindpm(next))) {
+            BQ25895_LOGI(BQ25895_LOG_POWER, "Oscillation: VINDPM %umV -> %umV", vindpmMV, next);
+            if (!oscillationRaisedVindpm_) {
+                oscillationSavedVindpm_ = reg0D;
+                oscillationRaisedVindpm_ = true;
+            }
+            changed = true;
+        }
+    }
+    if (changed) {
+        oscillation_.noteMitigation();
+        oscillation_.restartWindow(millis());
+    }
+}
+
+// Raises belong to the adapter that oscillated: a flap is short, a detach outlasts detachRestoreMs
+void BQ25895Driver::checkOscillationDetach() {
+    if (!oscillationRaisedTermination_ && !oscillationRaisedVindpm_) {
+        oscillationDetached_ = false;
+        return;
+    }
+    if (inputPowered(lastReg0B_)) {
+        oscillationDetached_ = false;
+        return;
+    }
+    unsigned long now = millis();
+    if (!oscillationDetached_) {
+        oscillationDetached_ = true;
+        oscillationDetachedSince_ = now;
+    }
+    if (now - oscillationDetachedSince_ >= oscillation_.config().detachRestoreMs) {
+        restoreOscillationMitigation();
+    }
+}
+
+void BQ25895Driver::restoreOscillationMitigation() {
+    if (!oscillationRaisedTermination_ && !oscillationRaisedVindpm_) {
+        return;
+    }
+    // Only ITERM is restored from the saved REG05; IPRECHG may have changed since
+    if (oscillationRaisedTermination_ &&
+        writeRegisterWithRetry(REG05_TIMER, (image_.value(REG05_TIMER) & 0xF0) | (oscillationSavedReg05_ & 0x0F))) {
+        oscillationRaisedTermination_ = false;
+    }
+    if (oscillationRaisedVindpm_ && writeRegisterWithRetry(REG0D_VINDPM, oscillationSavedVindpm_)) {
+        oscillationRaisedVindpm_ = false;
+    }
+    if (!oscillationRaisedTermination_ && !oscillationRaisedVindpm_) {
+        oscillationDetached_ = false;
+        BQ25895_LOGI(BQ25895_LOG_POWER, "Oscillation: ITERM/VINDPM restored");
+    }
+}
+
+// Brownout prediction
+void BQ25895Driver::configureBrownoutPredictor(const BQ25895BrownoutConfig& config) {
+    brownout_.configure(config);
+}
+
+void BQ25895Driver::disableBrownoutPredictor() {
+    brownout_.disable();
+}
+
+void BQ25895Driver::setBrownoutHook(BQ25895BrownoutHook hook) {
+    brownout_.setHook(hook);
+}
+
+BQ25895BrownoutState BQ25895Driver::getBrownoutState() const {
+    return brownout_.state();
+}
+
+// Power budget
+void BQ25895Driver::configurePowerBudget(const BQ25895PowerBudgetConfig& config) {
+    if (budgetRaisedInput_ && config.adapterLimitMA == 0) {
+        restoreBudgetInputLimit();
+    }
+    budget_.configure(config);
+    if (config.rebalance) {
+        captureChargeBase();
+    }
+}
+
+bool BQ25895Driver::disablePowerBudget() {
+    if (!budget_.enabled()) {
+        return true;
+    }
+    bool result = true;
+    if (budgetRaisedInput_) {
+        restoreBudgetInputLimit();
+        result = !budgetRaisedInput_;
+    }
+    bool rebalancing = budget_.rebalancing();
+    budget_.disable();
+    if (rebalancing) {
+        result = applyChargeTargets() && result;
+        chargeBaseCaptured_ = chargePoliciesActive();
+    }
+    return result;
+}
+
+void BQ25895Driver::setSystemLoad(uint32_t loadMW) {
+    budget_.setLoad(loadMW);
+}
+
+BQ25895PowerBudget BQ25895Driver::getPowerBudget() const {
+    return budget_.budget();
+}
+
+void BQ25895Driver::setPowerFlowEstimation(bool enabled, uint8_t efficiencyPercent) {
+    powerFlow_.setEfficiency(efficiencyPercent);
+    powerFlow_.setEnabled(enabled);
+}
+
+BQ25895PowerFlow BQ25895Driver::getPowerFlow() const {
+    return powerFlow_.flow();
+}
+
+// Thermal governor
+void BQ25895Driver::configureThermalGovernor(const BQ25895ThermalConfig& config) {
+    // The ceiling defaults to the ICHG currently allowed (configured, or set by a profile/zone);
+    // the base is kept so disabling restores it rather than a throttled setpoint
+    captureChargeBase();
+    uint16_t currentMA;
+    uint16_t voltageMV;
+    chargeTargetCeiling(currentMA, voltageMV);
+    thermal_.configure(config, currentMA);
+}
+
+bool BQ25895Driver::disableThermalGovernor() {
+    if (!thermal_.enabled()) {
+        return true;
+    }
+    thermal_.disable();
+    bool result = applyChargeTargets();
+    chargeBaseCaptured_ = chargePoliciesActive();
+    return result;
+}
+
+BQ25895ThermalState BQ25895Driver::getThermalState() const {
+    return thermal_.state();
 }
 
 // Charging control
@@ -284,10 +1017,12 @@ bool BQ25895Driver::setChargeCurrent(uint16_t currentMA) {
     }
     
     // BQ25895 charge current calculation: ICHG = 0mA + ICHG[6:0] × 64mA
-    // Min: 0mA, Max: 8064mA, Step: 64mA
-    uint8_t regValue = (currentMA / 64) & 0x7F;
+    // Min: 0mA, Max: 5056mA, Step: 64mA
+    uint8_t regValue = BQ25895Encode::chargeCurrent(currentMA);
     
-    return writeRegisterWithRetry(REG04_CHARGE_CURRENT, regValue);
+    // EN_PUMPX shares REG04 and belongs to high-voltage negotiation
+    return writeRegisterWithRetry(REG04_CHARGE_CURRENT,
+                                  (image_.value(REG04_CHARGE_CURRENT) & REG04_EN_PUMPX) | regValue);
 }
 
 bool BQ25895Driver::setInputCurrentLimit(uint16_t currentMA) {
@@ -298,16 +1033,11 @@ bool BQ25895Driver::setInputCurrentLimit(uint16_t currentMA) {
     
     // BQ25895 input current limit calculation
     // Base: 100mA, Step: 50mA up to 3.25A
-    uint8_t regValue;
-    if (currentMA <= 100) {
-        regValue = 0x00;
-    } else if (currentMA <= 3250) {
-        regValue = ((currentMA - 100) / 50) & 0x3F;
-    } else {
-        regValue = 0x3F; // Maximum
-    }
+    uint8_t regValue = BQ25895Encode::inputCurrent(currentMA);
     
-    return writeRegisterWithRetry(REG00_INPUT_CURRENT, regValue);
+    // EN_HIZ shares REG00 and belongs to the power path
+    return writeRegisterWithRetry(REG00_INPUT_CURRENT,
+                                  (image_.value(REG00_INPUT_CURRENT) & REG00_EN_HIZ) | regValue);
 }
 
 bool BQ25895Driver::setChargeVoltage(uint16_t voltageMV) {
@@ -317,9 +1047,9 @@ bool BQ25895Driver::setChargeVoltage(uint16_t voltageMV) {
     }
     
     // BQ25895 charge voltage calculation: VREG = 3.840V + VREG[7:2] × 16mV
-    // Min: 3.840V, Max: 4.848V, Step: 16mV
+    // Min: 3.840V, Max: 4.608V, Step: 16mV
     // Note: Voltage field is in bits 7:2, not 5:0
-    uint8_t voltageField = ((voltageMV - 3840) / 16) & 0x3F;
+    uint8_t voltageField = BQ25895Encode::chargeVoltage(voltageMV);
     
     // Read current register to preserve other bits
     uint8_t currentReg06;
@@ -331,7 +1061,7 @@ bool BQ25895Driver::setChargeVoltage(uint16_t voltageMV) {
     // Set voltage field in bits 7:2, preserve other bits
     uint8_t newReg06 = (currentReg06 & 0x03) | (voltageField << 2);
     
-    DEBUG_PRINTF("Setting charge voltage: %dmV (field=0x%02X, reg=0x%02X->0x%02X)\n", 
+    BQ25895_LOGD(BQ25895_LOG_CORE, "Setting charge voltage: %dmV (field=0x%02X, reg=0x%02X->0x%02X)", 
                  voltageMV, voltageField, currentReg06, newReg06);
     
     return writeRegisterWithRetry(REG06_CHARGE_VOLTAGE, newReg06);
@@ -345,14 +1075,7 @@ bool BQ25895Driver::setTerminationCurrent(uint16_t currentMA) {
     
     // BQ25895 termination current calculation: ITERM = 64mA + ITERM[3:0] × 64mA
     // Min: 64mA, Max: 1024mA, Step: 64mA
-    uint8_t itermValue;
-    if (currentMA <= 64) {
-        itermValue = 0x00;
-    } else if (currentMA <= 1024) {
-        itermValue = ((currentMA - 64) / 64) & 0x0F;
-    } else {
-        itermValue = 0x0F; // Maximum (1024mA)
-    }
+    uint8_t itermValue = BQ25895Encode::terminationCurrent(currentMA);
     
     // Read current REG05 value to preserve other bits
     uint8_t regValue;
@@ -367,6 +1090,336 @@ bool BQ25895Driver::setTerminationCurrent(uint16_t currentMA) {
     return writeRegisterWithRetry(REG05_TIMER, regValue);
 }
 
+// Input Current Optimizer
+bool BQ25895Driver::startInputCurrentOptimization(uint16_t ceilingMA, bool useCache) {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    
+    VBusType type = getVBusType();
+    ico_ = BQ25895IcoResult();
+    ico_.vbusType = type;
+    ico_.startTime = millis();
+    if (type == VBusType::NONE || type == VBusType::OTG) {
+        ico_.state = BQ25895IcoState::FAILED;
+        setError("ICO needs an input source");
+        return false;
+    }
+    
+    // A known adapter type gets its discovered limit back without another search
+    uint16_t cached = icoCache_[static_cast<uint8_t>(type)];
+    if (useCache && cached > 0) {
+        if (!setInputCurrentLimit(cached)) {
+            ico_.state = BQ25895IcoState::FAILED;
+            return false;
+        }
+        ico_.state = BQ25895IcoState::CACHED;
+        ico_.limitMA = cached;
+        ico_.fromCache = true;
+        BQ25895_LOGI(BQ25895_LOG_POWER, "ICO: reusing %umA for %s", cached, getVBusTypeName(type).c_str());
+        return true;
+    }
+    
+    // ICO searches upward until VINDPM engages, capped by IINLIM
+    if ((ceilingMA > 0 && !setInputCurrentLimit(ceilingMA)) ||
+        !updateRegisterBits(REG02_ADC_CONTROL, REG02_ICO_EN, REG02_ICO_EN) ||
+        !updateRegisterBits(REG09_NEW_FAULT, REG09_FORCE_ICO, REG09_FORCE_ICO)) {
+        ico_.state = BQ25895IcoState::FAILED;
+        setError("Failed to start ICO");
+        return false;
+    }
+    
+    ico_.state = BQ25895IcoState::RUNNING;
+    BQ25895_LOGI(BQ25895_LOG_POWER, "ICO: started on %s", getVBusTypeName(type).c_str());
+    return true;
+}
+
+BQ25895IcoState BQ25895Driver::pollInputCurrentOptimization() {
+    if (!initialized_) {
+        return ico_.state;
+    }
+    
+    // Attach detection reuses the last REG0B read (getStatus() in updateAll())
+    VBusType seen = static_cast<VBusType>((lastReg0B_ & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT);
+    if (icoOnAttach_ && seen != icoSeenVbus_ && ico_.state != BQ25895IcoState::RUNNING &&
+        seen != VBusType::NONE && seen != VBusType::OTG) {
+        startInputCurrentOptimization();
+    }
+    icoSeenVbus_ = seen;
+    
+    if (ico_.state != BQ25895IcoState::RUNNING) {
+        return ico_.state;
+    }
+    
+    uint8_t value;
+    const char* failure = nullptr;
+    if (!readRegisterWithRetry(REG0B_SYSTEM_STATUS, value)) {
+        failure = "ICO aborted: status read failed";
+    } else if (static_cast<VBusType>((value & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT) != ico_.vbusType) {
+        failure = "ICO aborted: input changed";
+    } else if (!readRegisterWithRetry(REG14_RESET, value)) {
+        failure = "ICO aborted: REG14 read failed";
+    } else if (value & REG14_ICO_OPTIMIZED) {
+        if (!readRegisterWithRetry(REG13_VDPMSTAT, value)) {
+            failure = "ICO aborted: REG13 read failed";
+        } else {
+            // IDPM_LIM: 100mA offset, 50mA step. It is programmed as the fixed IINLIM and
+            // ICO_EN is dropped so a reconnect does not trigger another search.
+            uint16_t limit = 100 + (value & REG13_IDPM_LIM_MASK) * 50;
+            updateRegisterBits(REG02_ADC_CONTROL, REG02_ICO_EN, 0x00);
+            if (!setInputCurrentLimit(limit)) {
+                failure = "ICO aborted: IINLIM write failed";
+            } else {
+                ico_.state = BQ25895IcoState::COMPLETE;
+                ico_.limitMA = limit;
+                ico_.durationMs = millis() - ico_.startTime;
+                icoCache_[static_cast<uint8_t>(ico_.vbusType)] = limit;
+                BQ25895_LOGI(BQ25895_LOG_POWER, "ICO: %s supports %umA (%lums)",
+                             getVBusTypeName(ico_.vbusType).c_str(), limit, ico_.durationMs);
+                return ico_.state;
+            }
+        }
+    } else if (millis() - ico_.startTime >= BQ25895_ICO_TIMEOUT_MS) {
+        failure = "ICO timed out";
+    }
+    
+    if (failure) {
+        updateRegisterBits(REG02_ADC_CONTROL, REG02_ICO_EN, 0x00);
+        ico_.state = BQ25895IcoState::FAILED;
+        ico_.durationMs = millis() - ico_.startTime;
+        setError(failure);
+    }
+    return ico_.state;
+}
+
+void BQ25895Driver::setInputCurrentOptimizationOnAttach(bool enabled) {
+    icoOnAttach_ = enabled;
+    // Only attaches after this call count; an adapter already present is left alone
+    icoSeenVbus_ = static_cast<VBusType>((lastReg0B_ & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT);
+}
+
+BQ25895IcoResult BQ25895Driver::getIcoResult() const {
+    return ico_;
+}
+
+uint16_t BQ25895Driver::getCachedInputLimit(VBusType type) const {
+    return icoCache_[static_cast<uint8_t>(type) & 0x07];
+}
+
+void BQ25895Driver::clearIcoCache() {
+    for (uint8_t i = 0; i < 8; i++) {
+        icoCache_[i] = 0;
+    }
+}
+
+// High-voltage adapter negotiation
+bool BQ25895Driver::startHighVoltageNegotiation(const BQ25895HvConfig& config) {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    if (hv_.state == BQ25895HvState::NEGOTIATING || hv_.state == BQ25895HvState::ACTIVE) {
+        setError("High-voltage input already negotiated");
+        return false;
+    }
+    
+    // Only wall adapters (DCP, HVDCP, MaxCharge reports as non-standard) can raise VBUS
+    VBusType type = getVBusType();
+    if (type != VBusType::USB_DCP && type != VBusType::HVDCP && type != VBusType::NON_STANDARD) {
+        setError("Input is not a high-voltage capable adapter");
+        return false;
+    }
+    
+    hvConfig_ = config;
+    hv_ = BQ25895HvResult();
+    hv_.startTime = millis();
+    uint16_t cap = config_.voltageSafetyLimitMV > config.marginMV ? config_.voltageSafetyLimitMV - config.marginMV : 0;
+    hv_.ceilingMV = config.targetMV < cap ? config.targetMV : cap;
+    if (hv_.ceilingMV < 5000 + BQ25895_HV_MIN_RISE_MV) {
+        hv_.state = BQ25895HvState::LIMITED;
+        setError("Voltage safety limit leaves no room above 5V");
+        return false;
+    }
+    
+    hvSavedInput_ = image_.value(REG00_INPUT_CURRENT);
+    hvSavedVindpm_ = image_.vindpm;
+    hvBaselineMV_ = 0;
+    hvSteppedDown_ = false;
+    if (!updateRegisterBits(REG02_ADC_CONTROL, REG02_HVDCP_EN | REG02_MAXC_EN, REG02_HVDCP_EN | REG02_MAXC_EN) ||
+        !updateRegisterBits(REG04_CHARGE_CURRENT, REG04_EN_PUMPX, REG04_EN_PUMPX)) {
+        abortHvNegotiation(BQ25895HvState::FAILED, "Failed to enable adapter handshake");
+        return false;
+    }
+    
+    // The first measurement is the 5V baseline; pulses follow from there
+    hv_.state = BQ25895HvState::NEGOTIATING;
+    hvPhase_ = HvPhase::SETTLE;
+    hvPhaseStart_ = millis();
+    BQ25895_LOGI(BQ25895_LOG_POWER, "HV: negotiating up to %umV on %s", hv_.ceilingMV, getVBusTypeName(type).c_str());
+    return true;
+}
+
+BQ25895HvState BQ25895Driver::pollHighVoltageNegotiation() {
+    if (!initialized_) {
+        return hv_.state;
+    }
+    
+    // A detached adapter takes its voltage with it; the next one starts at 5V
+    if (hv_.state == BQ25895HvState::ACTIVE) {
+        if (((lastReg0B_ & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT) == static_cast<uint8_t>(VBusType::NONE)) {
+            revertToDefaultVoltage();
+        }
+        return hv_.state;
+    }
+    if (hv_.state != BQ25895HvState::NEGOTIATING) {
+        return hv_.state;
+    }
+    
+    unsigned long now = millis();
+    if (now - hv_.startTime >= BQ25895_HV_TIMEOUT_MS) {
+        abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation timed out");
+        return hv_.state;
+    }
+    
+    uint8_t value;
+    if (hvPhase_ == HvPhase::SETTLE) {
+        // Wait for the adapter to settle and the pulse sequence to finish
+        if (now - hvPhaseStart_ < (hv_.steps > 0 ? hvConfig_.settleMs : 0) ||
+            !readRegisterWithRetry(REG09_NEW_FAULT, value) || (value & (REG09_PUMPX_UP | REG09_PUMPX_DN))) {
+            return hv_.state;
+        }
+        writeRegisterWithRetry(REG02_ADC_CONTROL, image_.value(REG02_ADC_CONTROL) | REG02_CONV_START);
+        hvPhase_ = HvPhase::CONVERT;
+        hvPhaseStart_ = now;
+        return hv_.state;
+    }
+    
+    if (now - hvPhaseStart_ < BQ25895_ADC_CONVERSION_MS) {
+        return hv_.state;
+    }
+    if (!readRegisterWithRetry(REG11_VBUSV, value)) {
+        abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation: VBUS read failed");
+        return hv_.state;
+    }
+    uint16_t vbus = 2600 + (value & 0x7F) * 100;
+    hv_.vbusMV = vbus;
+    
+    if (vbus > config_.voltageSafetyLimitMV) {
+        abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation: VBUS above safety limit");
+        return hv_.state;
+    }
+    if (hvBaselineMV_ == 0) {
+        hvBaselineMV_ = vbus;
+        hvLastMV_ = vbus;
+        issueHvPulse(REG09_PUMPX_UP);
+        return hv_.state;
+    }
+    
+    bool raised = vbus >= hvBaselineMV_ + BQ25895_HV_MIN_RISE_MV;
+    if (vbus > hv_.ceilingMV) {
+        // Overshot the cap (e.g. a 5V->12V jump): one step back, then give up
+        if (hvSteppedDown_) {
+            abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation: adapter cannot stay below the cap");
+        } else {
+            hvSteppedDown_ = true;
+            hvLastMV_ = vbus;
+            issueHvPulse(REG09_PUMPX_DN);
+        }
+        return hv_.state;
+    }
+    if (!raised) {
+        if (hvSteppedDown_) {
+            abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation: adapter cannot stay below the cap");
+        } else {
+            abortHvNegotiation(BQ25895HvState::UNSUPPORTED, "Adapter did not raise VBUS");
+        }
+        return hv_.state;
+    }
+    
+    uint16_t rise = vbus > hvLastMV_ ? vbus - hvLastMV_ : 0;
+    hvLastMV_ = vbus;
+    if (hvSteppedDown_ || rise < BQ25895_HV_MIN_RISE_MV || vbus + rise > hv_.ceilingMV ||
+        hv_.steps >= hvConfig_.maxSteps) {
+        finishHvNegotiation(vbus);
+    } else {
+        issueHvPulse(REG09_PUMPX_UP);
+    }
+    return hv_.state;
+}
+
+bool BQ25895Driver::issueHvPulse(uint8_t pulse) {
+    // PUMPX_UP/DN self-clear once the current pulse sequence has been sent
+    if (!updateRegisterBits(REG09_NEW_FAULT, pulse, pulse)) {
+        abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation: pulse write failed");
+        return false;
+    }
+    hv_.steps++;
+    hvPhase_ = HvPhase::SETTLE;
+    hvPhaseStart_ = millis();
+    return true;
+}
+
+void BQ25895Driver::finishHvNegotiation(uint16_t vbusMV) {
+    // Same adapter power at a higher voltage needs less input current; VINDPM tracks
+    // the new VBUS so a sagging adapter is still caught before it collapses
+    uint32_t inputMA = static_cast<uint32_t>(hvConfig_.adapterPowerMW) * 1000 / vbusMV;
+    hv_.inputLimitMA = static_cast<uint16_t>(inputMA > 3250 ? 3250 : inputMA);
+    uint16_t vindpm = vbusMV - vbusMV / 8;
+    if (vindpm < config_.vindpmThresholdMV) {
+        vindpm = config_.vindpmThresholdMV;
+    }
+    hv_.vindpmMV = vindpm;
+    
+    if (!setInputCurrentLimit(hv_.inputLimitMA) ||
+        !writeRegisterWithRetry(REG0D_VINDPM, 0x80 | BQ25895Encode::vindpm(vindpm))) {
+        abortHvNegotiation(BQ25895HvState::FAILED, "HV negotiation: retune failed");
+        return;
+    }
+    hv_.state = BQ25895HvState::ACTIVE;
+    hv_.durationMs = millis() - hv_.startTime;
+    BQ25895_LOGI(BQ25895_LOG_POWER, "HV: %umV after %u steps, IINLIM %umA, VINDPM %umV",
+                 vbusMV, hv_.steps, hv_.inputLimitMA, vindpm);
+}
+
+void BQ25895Driver::abortHvNegotiation(BQ25895HvState state, const char* reason) {
+    updateRegisterBits(REG04_CHARGE_CURRENT, REG04_EN_PUMPX, 0x00);
+    updateRegisterBits(REG02_ADC_CONTROL, REG02_HVDCP_EN | REG02_MAXC_EN, 0x00);
+    // With the handshakes disabled, input re-detection drops the adapter back to 5V
+    if (hv_.steps > 0) {
+        updateRegisterBits(REG02_ADC_CONTROL, REG02_FORCE_DPDM, REG02_FORCE_DPDM);
+    }
+    // Only IINLIM is restored; EN_HIZ/EN_ILIM may have changed since
+    writeRegisterWithRetry(REG00_INPUT_CURRENT, (image_.value(REG00_INPUT_CURRENT) & 0xC0) | (hvSavedInput_ & 0x3F));
+    writeRegisterWithRetry(REG0D_VINDPM, hvSavedVindpm_);
+    
+    hv_.state = state;
+    hv_.durationMs = millis() - hv_.startTime;
+    if (reason) {
+        setError(reason);
+        BQ25895_LOGW(BQ25895_LOG_POWER, "HV: %s, back to 5V", reason);
+    } else {
+        BQ25895_LOGI(BQ25895_LOG_POWER, "HV: released, back to 5V");
+    }
+}
+
+bool BQ25895Driver::revertToDefaultVoltage() {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    if (hv_.state != BQ25895HvState::NEGOTIATING && hv_.state != BQ25895HvState::ACTIVE) {
+        return true;
+    }
+    
+    abortHvNegotiation(BQ25895HvState::IDLE, nullptr);
+    return true;
+}
+
+BQ25895HvResult BQ25895Driver::getHighVoltageResult() const {
+    return hv_;
+}
+
 // VBUS and power management
 VBusType BQ25895Driver::getVBusType() {
     if (!initialized_) {
@@ -407,15 +1460,15 @@ bool BQ25895Driver::clearFaults() {
     }
     
     uint8_t faultReg;
-    if (readRegisterWithRetry(REG0C_FAULT, faultReg) && faultReg != 0) {
-        DEBUG_PRINTF("Clearing BQ25895 faults: 0x%02X\n", faultReg);
+    if (readFaults(faultReg) && faultReg != 0) {
+        BQ25895_LOGI(BQ25895_LOG_FAULT, "Clearing BQ25895 faults: 0x%02X", faultReg);
         
         // Decode fault bits for debugging
-        if (faultReg & 0x80) DEBUG_PRINTLN("  - WATCHDOG_FAULT");
-        if (faultReg & 0x40) DEBUG_PRINTLN("  - OTG_FAULT");
-        if (faultReg & 0x30) DEBUG_PRINTLN("  - CHRG_FAULT");
-        if (faultReg & 0x08) DEBUG_PRINTLN("  - BAT_FAULT");
-        if (faultReg & 0x07) DEBUG_PRINTLN("  - NTC_FAULT");
+        if (faultReg & 0x80) BQ25895_LOGD(BQ25895_LOG_FAULT, "  - WATCHDOG_FAULT");
+        if (faultReg & 0x40) BQ25895_LOGD(BQ25895_LOG_FAULT, "  - OTG_FAULT");
+        if (faultReg & 0x30) BQ25895_LOGD(BQ25895_LOG_FAULT, "  - CHRG_FAULT");
+        if (faultReg & 0x08) BQ25895_LOGD(BQ25895_LOG_FAULT, "  - BAT_FAULT");
+        if (faultReg & 0x07) BQ25895_LOGD(BQ25895_LOG_FAULT, "  - NTC_FAULT");
     }
     
     // Clear faults by re-writing key registers
@@ -423,9 +1476,9 @@ bool BQ25895Driver::clearFaults() {
     writeRegisterWithRetry(REG03_CHARGE_CONFIG, 0x1A); // Reset charge config
     
     // Force ADC conversion to reset ADC-related faults
-    writeRegisterWithRetry(0x02, 0x80);
+    writeRegisterWithRetry(REG02_ADC_CONTROL, image_.value(REG02_ADC_CONTROL) | REG02_CONV_START);
     
-    DEBUG_PRINTLN("Fault clearing complete");
+    BQ25895_LOGD(BQ25895_LOG_FAULT, "Fault clearing complete");
     return true;
 }
 
@@ -435,9 +1488,8 @@ uint8_t BQ25895Driver::getFaultRegister() {
     }
     
     uint8_t value;
-    // Read twice to get current fault status
-    readRegisterWithRetry(REG0C_FAULT, value); // Clear latched faults
-    if (readRegisterWithRetry(REG0C_FAULT, value)) {
+    // Single read: latched faults are kept by the fault accumulator
+    if (readFaults(value)) {
         return value;
     }
     
@@ -465,66 +1517,304 @@ String BQ25895Driver::decodeFaults(uint8_t faultReg) {
         result += " fault(s)";
     }
     
-    return result;
+    return result;
+}
+
+uint8_t BQ25895Driver::categorizeFaults(uint8_t faultReg) {
+    uint8_t categories = 0;
+    if (faultReg & 0x80) categories |= BQ25895FaultMask(BQ25895Fault::WATCHDOG);
+    if (faultReg & 0x40) categories |= BQ25895FaultMask(BQ25895Fault::BOOST);
+    switch ((faultReg >> 4) & 0x03) {
+        case 1: categories |= BQ25895FaultMask(BQ25895Fault::CHARGE_INPUT); break;
+        case 2: categories |= BQ25895FaultMask(BQ25895Fault::CHARGE_THERMAL); break;
+        case 3: categories |= BQ25895FaultMask(BQ25895Fault::CHARGE_TIMER); break;
+    }
+    if (faultReg & 0x08) categories |= BQ25895FaultMask(BQ25895Fault::BATTERY_OVP);
+    switch (faultReg & 0x03) { // Buck and boost NTC codes share the low two bits
+        case 1: categories |= BQ25895FaultMask(BQ25895Fault::NTC_COLD); break;
+        case 2: categories |= BQ25895FaultMask(BQ25895Fault::NTC_HOT); break;
+    }
+    return categories;
+}
+
+BQ25895FaultSummary BQ25895Driver::getFaultSummary() const {
+    return faults_;
+}
+
+uint8_t BQ25895Driver::getCurrentFaults() const {
+    return faults_.current;
+}
+
+uint8_t BQ25895Driver::getUnacknowledgedFaults() const {
+    return faults_.unacknowledged;
+}
+
+const BQ25895EventHistory& BQ25895Driver::getEventHistory() const {
+    return events_;
+}
+
+void BQ25895Driver::clearEventHistory() {
+    events_.clear();
+}
+
+void BQ25895Driver::acknowledgeFaults() {
+    faults_.unacknowledged = 0;
+    for (uint8_t i = 0; i < BQ25895_FAULT_CATEGORIES; i++) {
+        faults_.records[i].firstSeen = 0;
+    }
+}
+
+// Procedure engine
+bool BQ25895Driver::startProcedure(BQ25895ProcedureId id, uint32_t timeoutMs) {
+    if (!procedure_.start(id, millis(), timeoutMs)) {
+        setError("Another procedure is running");
+        return false;
+    }
+    BQ25895_LOGD(BQ25895_LOG_POWER, "Procedure %u started", static_cast<uint8_t>(id));
+    return true;
+}
+
+bool BQ25895Driver::tick() {
+    bool ran = false;
+    for (uint8_t i = 0; i < BQ25895_PROCEDURE_STEPS_PER_TICK && procedure_.ready(millis()); i++) {
+        ran = true;
+        if (!procedure_.apply(runProcedureStep(), millis())) {
+            continue;
+        }
+        const BQ25895ProcedureState& state = procedure_.state();
+        if (state.status == BQ25895ProcedureStatus::FAILED) {
+            BQ25895_LOGW(BQ25895_LOG_POWER, "Procedure %u failed at step %u: %s",
+                         static_cast<uint8_t>(state.id), state.step, state.failure);
+            setError(state.failure);
+        } else {
+            BQ25895_LOGD(BQ25895_LOG_POWER, "Procedure %u done in %lums", static_cast<uint8_t>(state.id),
+                         (unsigned long)(state.finished - state.started));
+        }
+    }
+    if (ran) {
+        procedure_.noteTick();
+    }
+    return procedure_.running();
+}
+
+// Blocking form for the synchronous API: waits are slept (on hardware) rather than polled, and
+// the time spent counts toward the deadline even where millis() does not advance
+bool BQ25895Driver::finishProcedure() {
+    uint32_t waitedMs = 0;
+    while (tick()) {
+        uint32_t waitMs = procedure_.remainingWaitMs(millis());
+        if (waitMs == 0) {
+            continue;
+        }
+        waitedMs += waitMs;
+        if (waitedMs > procedure_.timeoutMs()) {
+            procedure_.abort(millis(), "Procedure timed out");
+            setError("Procedure timed out");
+            break;
+        }
+        #if defined(ARDUINO)
+        PLATFORM_DELAY(waitMs);
+        #endif
+        procedure_.wake();
+    }
+    return procedure_.state().status == BQ25895ProcedureStatus::DONE;
+}
+
+BQ25895StepResult BQ25895Driver::runProcedureStep() {
+    uint8_t step = procedure_.step();
+    switch (procedure_.id()) {
+        case BQ25895ProcedureId::FACTORY_RESET: return factoryResetStep(step);
+        case BQ25895ProcedureId::USB_RECOVERY: return usbRecoveryStep(step);
+        case BQ25895ProcedureId::EMERGENCY_ENTER: return emergencyEnterStep(step);
+        case BQ25895ProcedureId::EMERGENCY_EXIT: return emergencyExitStep(step);
+        case BQ25895ProcedureId::FORCE_RESTART_CHARGING: return forceRestartChargingStep(step);
+        default: return BQ25895StepResult::fail("Unknown procedure");
+    }
+}
+
+bool BQ25895Driver::isProcedureRunning() const {
+    return procedure_.running();
+}
+
+BQ25895ProcedureState BQ25895Driver::getProcedureState() const {
+    return procedure_.state();
+}
+
+BQ25895StepResult BQ25895Driver::factoryResetStep(uint8_t step) {
+    if (step == 0) {
+        BQ25895_LOGI(BQ25895_LOG_INIT, "Performing factory reset...");
+        
+        // Send reset command, then give the charger time to reload its defaults
+        if (!writeRegisterWithRetry(REG14_RESET, 0x80)) {
+            return BQ25895StepResult::fail("Failed to send reset command");
+        }
+        return BQ25895StepResult::next(500);
+    }
+    
+    if (!resetComplete()) {
+        return BQ25895StepResult::poll(10);
+    }
+    BQ25895_LOGI(BQ25895_LOG_INIT, "Factory reset complete");
+    reset(); // Mark as uninitialized
+    return BQ25895StepResult::done();
+}
+
+// REG_RST clears itself once the registers are back at their defaults
+bool BQ25895Driver::resetComplete() {
+    uint8_t value;
+    return readRegisterWithRetry(REG14_RESET, value) && (value & 0x80) == 0;
+}
+
+// Emergency modes
+bool BQ25895Driver::enterEmergencyBatteryMode() {
+    return startEmergencyEntry() && finishProcedure();
+}
+
+bool BQ25895Driver::exitEmergencyMode() {
+    return startEmergencyExit() && finishProcedure();
+}
+
+bool BQ25895Driver::startEmergencyEntry() {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    // Safety first: whatever was running gives way
+    if (procedure_.running()) {
+        BQ25895_LOGW(BQ25895_LOG_POWER, "Procedure %u preempted by emergency entry",
+                     static_cast<uint8_t>(procedure_.id()));
+        procedure_.abort(millis(), "Preempted by emergency entry");
+    }
+    return startProcedure(BQ25895ProcedureId::EMERGENCY_ENTER, 1000);
+}
+
+bool BQ25895Driver::startEmergencyExit() {
+    if (!initialized_) {
+        setError("Driver not initialized");
+        return false;
+    }
+    return startProcedure(BQ25895ProcedureId::EMERGENCY_EXIT, 1000);
+}
+
+BQ25895StepResult BQ25895Driver::emergencyEnterStep(uint8_t step) {
+    switch (step) {
+        case 0:
+            BQ25895_LOGI(BQ25895_LOG_POWER, "Entering emergency battery mode...");
+            // Disable charging completely
+            if (!writeRegisterWithRetry(REG03_CHARGE_CONFIG, 0x00)) {
+                return BQ25895StepResult::fail("Failed to disable charging");
+            }
+            return BQ25895StepResult::next();
+        case 1:
+            // Disable input current detection
+            if (!writeRegisterWithRetry(REG00_INPUT_CURRENT, 0x01)) {
+                return BQ25895StepResult::fail("Failed to set minimum input current");
+            }
+            return BQ25895StepResult::next();
+        case 2:
+            // Disable VBUS detection
+            if (!writeRegisterWithRetry(REG0D_VINDPM, 0x80)) {
+                return BQ25895StepResult::fail("Failed to disable VBUS detection");
+            }
+            return BQ25895StepResult::next();
+        case 3:
+            // Disable USB detection circuits
+            if (!writeRegisterWithRetry(REG07_MISC_OPERATION, 0x40)) {
+                return BQ25895StepResult::fail("Failed to disable USB detection");
+            }
+            return BQ25895StepResult::next();
+        default: {
+            // Clear fault register
+            uint8_t dummy;
+            readFaults(dummy);
+            
+            emergencyMode_ = true;
+            recordEvent(BQ25895EventCode::EMERGENCY_ENTER);
+            BQ25895_LOGI(BQ25895_LOG_POWER, "Emergency battery mode activated");
+            return BQ25895StepResult::done();
+        }
+    }
+}
+
+BQ25895StepResult BQ25895Driver::emergencyExitStep(uint8_t step) {
+    if (step == 0) {
+        emergencyMode_ = false;
+        recordEvent(BQ25895EventCode::EMERGENCY_EXIT);
+        return BQ25895StepResult::next();
+    }
+    
+    // Re-initialize with current configuration
+    if (!initialize(config_)) {
+        return BQ25895StepResult::fail("Re-initialization failed");
+    }
+    return BQ25895StepResult::done();
 }
 
-// Emergency modes
-bool BQ25895Driver::enterEmergencyBatteryMode() {
+bool BQ25895Driver::isInEmergencyMode() const {
+    return emergencyMode_;
+}
+
+// Fast power path: written from the register image, so no read-modify-write round trips
+bool BQ25895Driver::setPowerPath(BQ25895PowerPath path) {
     if (!initialized_) {
         setError("Driver not initialized");
         return false;
     }
-    
-    DEBUG_PRINTLN("Entering emergency battery mode...");
-    
-    // Disable charging completely
-    if (!writeRegisterWithRetry(REG03_CHARGE_CONFIG, 0x00)) {
-        setError("Failed to disable charging");
+    if (emergencyMode_) {
+        setError("Power path unavailable in emergency mode");
         return false;
     }
     
-    // Disable input current detection
-    if (!writeRegisterWithRetry(REG00_INPUT_CURRENT, 0x01)) {
-        setError("Failed to set minimum input current");
-        return false;
-    }
+    unsigned long startUs = micros();
+    uint16_t startTransactions = busTransactions_;
+    uint8_t reg00 = image_.value(REG00_INPUT_CURRENT);
+    uint8_t reg03 = image_.value(REG03_CHARGE_CONFIG);
+    bool hiz = path == BQ25895PowerPath::BATTERY;
     
-    // Disable VBUS detection
-    if (!writeRegisterWithRetry(REG0D_VINDPM, 0x80)) {
-        setError("Failed to disable VBUS detection");
+    // Leaving HIZ first (and entering it last) keeps the system on a live input throughout
+    if (!hiz && (reg00 & REG00_EN_HIZ) &&
+        !writeRegisterWithRetry(REG00_INPUT_CURRENT, reg00 & ~REG00_EN_HIZ)) {
+        setError("Failed to resume input");
         return false;
     }
-    
-    // Disable USB detection circuits
-    if (!writeRegisterWithRetry(REG07_MISC_OPERATION, 0x40)) {
-        setError("Failed to disable USB detection");
+    if (path != BQ25895PowerPath::BATTERY) {
+        uint8_t charge = path == BQ25895PowerPath::ADAPTER ? REG03_CHG_CONFIG : 0;
+        if ((reg03 & REG03_CHG_CONFIG) != charge &&
+            !writeRegisterWithRetry(REG03_CHARGE_CONFIG, (reg03 & ~REG03_CHG_CONFIG) | charge)) {
+            setError("Failed to change charge enable");
+            return false;
+        }
+    }
+    if (hiz && !(reg00 & REG00_EN_HIZ) &&
+        !writeRegisterWithRetry(REG00_INPUT_CURRENT, reg00 | REG00_EN_HIZ)) {
+        setError("Failed to suspend input");
         return false;
     }
     
-    // Clear fault register
-    uint8_t dummy;
-    readRegisterWithRetry(REG0C_FAULT, dummy);
-    
-    emergencyMode_ = true;
-    DEBUG_PRINTLN("Emergency battery mode activated");
-    
+    uint16_t transactions = busTransactions_ - startTransactions;
+    if (transactions == 0) {
+        return true;
+    }
+    powerPathReport_.path = path;
+    powerPathReport_.busTransactions = transactions;
+    powerPathReport_.durationUs = micros() - startUs;
+    powerPathReport_.timestamp = millis();
+    recordEvent(BQ25895EventCode::POWER_PATH, static_cast<uint8_t>(path));
+    BQ25895_LOGD(BQ25895_LOG_POWER, "Power path %u in %u transaction(s), %luus", static_cast<uint8_t>(path),
+                 transactions, powerPathReport_.durationUs);
     return true;
 }
 
-bool BQ25895Driver::exitEmergencyMode() {
-    if (!initialized_) {
-        setError("Driver not initialized");
-        return false;
+BQ25895PowerPath BQ25895Driver::getPowerPath() const {
+    if (image_.value(REG00_INPUT_CURRENT) & REG00_EN_HIZ) {
+        return BQ25895PowerPath::BATTERY;
     }
-    
-    emergencyMode_ = false;
-    
-    // Re-initialize with current configuration
-    return initialize(config_);
+    return (image_.value(REG03_CHARGE_CONFIG) & REG03_CHG_CONFIG) ? BQ25895PowerPath::ADAPTER
+                                                                   : BQ25895PowerPath::NO_CHARGE;
 }
 
-bool BQ25895Driver::isInEmergencyMode() const {
-    return emergencyMode_;
+BQ25895PowerPathReport BQ25895Driver::getPowerPathReport() const {
+    return powerPathReport_;
 }
 
 // Watchdog management
@@ -553,7 +1843,7 @@ bool BQ25895Driver::enterShipMode() {
         return false;
     }
     
-    DEBUG_PRINTLN("Entering ship mode...");
+    BQ25895_LOGI(BQ25895_LOG_POWER, "Entering ship mode...");
     
     // Set BATFET_DIS bit to enter ship mode
     return writeRegisterWithRetry(REG09_NEW_FAULT, 0x20);
@@ -578,66 +1868,126 @@ bool BQ25895Driver::checkStartupScenario(bool externalPowerPresent) {
 }
 
 bool BQ25895Driver::handleUSBReconnection(bool externalPowerPresent) {
+    recoveryExternalPower_ = externalPowerPresent;
+    
+    // Handle ongoing reconnection; it keeps running through the reset it may perform
+    if (procedure_.running() && procedure_.id() == BQ25895ProcedureId::USB_RECOVERY) {
+        return tick() || procedure_.state().status == BQ25895ProcedureStatus::DONE;
+    }
+    
     if (!initialized_) {
         setError("Driver not initialized");
         return false;
     }
     
-    unsigned long now = millis();
-    
     // Detect USB reconnection
-    if (externalPowerPresent && !usbReconnectionInProgress_) {
-        usbReconnectionInProgress_ = true;
-        usbReconnectionStartTime_ = now;
+    if (externalPowerPresent) {
+        if (!startProcedure(BQ25895ProcedureId::USB_RECOVERY, 10000)) {
+            return false;
+        }
         logWithTimestamp("USB reconnection detected - starting recovery");
-        return true;
+        tick();
     }
     
-    // Handle ongoing reconnection
-    if (usbReconnectionInProgress_) {
-        // Wait 2 seconds for system to stabilize
-        if (now - usbReconnectionStartTime_ < 2000) {
-            return true; // Still waiting
-        }
-        
-        // Check if BQ25895 USB detection is working
-        uint8_t sysStatus;
-        if (!readRegisterWithRetry(REG0B_SYSTEM_STATUS, sysStatus)) {
-            logWithTimestamp("USB recovery failed - I2C communication error");
-            usbReconnectionInProgress_ = false;
-            return false;
-        }
-        
-        uint8_t vbusStatus = (sysStatus >> 5) & 0x07;
-        bool bq25895UsbDetected = (vbusStatus != 0x00);
-        
-        if (externalPowerPresent && !bq25895UsbDetected) {
-            logWithTimestamp("USB recovery needed - BQ25895 USB detection broken");
-            
-            // Reset and re-initialize
-            factoryReset();
-            #if defined(ARDUINO)
-            PLATFORM_DELAY(100);
-            #endif
+    return true;
+}
+
+// Escalation ladder: FORCE_DPDM re-detection keeps the configuration and costs a few
+// transactions; REG_RST plus initialize() is the last resort
+BQ25895StepResult BQ25895Driver::usbRecoveryStep(uint8_t step) {
+    switch (step) {
+        case 0:
+            // Wait 2 seconds for system to stabilize
+            return BQ25895StepResult::next(2000);
+        case 1: {
+            recoveryReport_ = BQ25895RecoveryReport();
+            recoveryStart_ = millis();
+            recoveryStartTransactions_ = busTransactions_;
             
-            bool initSuccess = initialize(config_);
-            if (initSuccess) {
-                enableCharging();
-                logWithTimestamp("USB recovery complete - BQ25895 reset and reinitialized");
-            } else {
-                logWithTimestamp("USB recovery failed - initialization error");
+            // Check if BQ25895 USB detection is working
+            uint8_t sysStatus;
+            if (!readRegisterWithRetry(REG0B_SYSTEM_STATUS, sysStatus)) {
+                logWithTimestamp("USB recovery failed - I2C communication error");
+                finishRecovery(false);
+                return BQ25895StepResult::fail("USB recovery failed - I2C communication error");
             }
             
-            usbReconnectionInProgress_ = false;
-            return initSuccess;
-        } else {
-            logWithTimestamp("USB recovery not needed - BQ25895 detection working");
-            usbReconnectionInProgress_ = false;
-            return true;
+            uint8_t vbusStatus = (sysStatus >> 5) & 0x07;
+            if (!recoveryExternalPower_ || vbusStatus != 0x00) {
+                logWithTimestamp("USB recovery not needed - BQ25895 detection working");
+                finishRecovery(true);
+                return BQ25895StepResult::done();
+            }
+            logWithTimestamp("USB recovery needed - BQ25895 USB detection broken");
+            return BQ25895StepResult::next();
+        }
+        case 2:
+            // Re-run D+/D- detection; the bit clears itself when detection is done
+            if (recoveryReport_.redetectAttempts >= BQ25895_DPDM_ATTEMPTS) {
+                return BQ25895StepResult::jump(4);
+            }
+            recoveryReport_.rung = BQ25895RecoveryRung::REDETECT;
+            recoveryReport_.redetectAttempts++;
+            recoveryRungStart_ = millis();
+            if (!writeRegisterWithRetry(REG02_ADC_CONTROL, image_.value(REG02_ADC_CONTROL) | REG02_FORCE_DPDM)) {
+                return BQ25895StepResult::jump(4);
+            }
+            return BQ25895StepResult::next(BQ25895_DPDM_POLL_MS);
+        case 3: {
+            uint8_t value;
+            if (!readRegisterWithRetry(REG02_ADC_CONTROL, value) || (value & REG02_FORCE_DPDM)) {
+                if (millis() - recoveryRungStart_ >= BQ25895_DPDM_TIMEOUT_MS) {
+                    return BQ25895StepResult::jump(2);
+                }
+                return BQ25895StepResult::poll(BQ25895_DPDM_POLL_MS);
+            }
+            if (readRegisterWithRetry(REG0B_SYSTEM_STATUS, value) && (value & VBUS_STAT_MASK) != 0) {
+                logWithTimestamp("USB recovery complete - source re-detected");
+                finishRecovery(true);
+                return BQ25895StepResult::done();
+            }
+            return BQ25895StepResult::jump(2);
         }
+        case 4:
+            logWithTimestamp("USB re-detection failed - resetting BQ25895");
+            recoveryReport_.rung = BQ25895RecoveryRung::FULL_RESET;
+            if (!writeRegisterWithRetry(REG14_RESET, 0x80)) {
+                finishRecovery(false);
+                return BQ25895StepResult::fail("Failed to send reset command");
+            }
+            return BQ25895StepResult::next(500);
+        case 5:
+            if (!resetComplete()) {
+                return BQ25895StepResult::poll(10);
+            }
+            reset(); // Mark as uninitialized
+            return BQ25895StepResult::next(100);
+        default:
+            // Re-initialize
+            if (!initialize(config_)) {
+                logWithTimestamp("USB recovery failed - initialization error");
+                finishRecovery(false);
+                return BQ25895StepResult::fail("USB recovery failed - initialization error");
+            }
+            enableCharging();
+            logWithTimestamp("USB recovery complete - BQ25895 reset and reinitialized");
+            finishRecovery(true);
+            return BQ25895StepResult::done();
     }
-    
-    return true;
+}
+
+void BQ25895Driver::finishRecovery(bool recovered) {
+    recoveryReport_.recovered = recovered;
+    recoveryReport_.busTransactions = busTransactions_ - recoveryStartTransactions_;
+    recoveryReport_.timestamp = millis();
+    recoveryReport_.durationMs = recoveryReport_.timestamp - recoveryStart_;
+    BQ25895_LOGI(BQ25895_LOG_POWER, "USB recovery: rung %u, %u re-detection(s), %u transactions, %lums",
+                 static_cast<uint8_t>(recoveryReport_.rung), recoveryReport_.redetectAttempts,
+                 recoveryReport_.busTransactions, recoveryReport_.durationMs);
+}
+
+BQ25895RecoveryReport BQ25895Driver::getRecoveryReport() const {
+    return recoveryReport_;
 }
 
 bool BQ25895Driver::handlePowerLoss() {
@@ -646,6 +1996,7 @@ bool BQ25895Driver::handlePowerLoss() {
     }
     
     logWithTimestamp("External power lost - performing cleanup");
+    recordEvent(BQ25895EventCode::POWER_LOSS);
     
     // Disable charging completely
     if (!writeRegisterWithRetry(REG03_CHARGE_CONFIG, 0x00)) {
@@ -669,7 +2020,7 @@ bool BQ25895Driver::handlePowerLoss() {
     
     // Clear fault registers
     uint8_t dummy;
-    readRegisterWithRetry(REG0C_FAULT, dummy);
+    readFaults(dummy);
     
     logWithTimestamp("Power loss cleanup complete");
     return true;
@@ -693,7 +2044,7 @@ bool BQ25895Driver::prepareForShutdown() {
     
     // Clear all fault conditions
     uint8_t dummy;
-    readRegisterWithRetry(REG0C_FAULT, dummy);
+    readFaults(dummy);
     
     logWithTimestamp("Shutdown preparation complete");
     return true;
@@ -702,51 +2053,51 @@ bool BQ25895Driver::prepareForShutdown() {
 // Enhanced diagnostics
 void BQ25895Driver::printExtendedDiagnostics() {
     if (!initialized_) {
-        DEBUG_PRINTLN("Driver not initialized for extended diagnostics");
+        BQ25895_LOGW(BQ25895_LOG_DIAG, "Driver not initialized for extended diagnostics");
         return;
     }
     
-    DEBUG_PRINTLN("=== EXTENDED BQ25895 DIAGNOSTICS ===");
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "=== EXTENDED BQ25895 DIAGNOSTICS ===");
     
     uint8_t reg0B, reg0C, reg06, reg04, reg11, reg12;
     bool success = true;
     
     success &= readRegisterWithRetry(REG0B_SYSTEM_STATUS, reg0B);
-    success &= readRegisterWithRetry(REG0C_FAULT, reg0C);
+    success &= readFaults(reg0C);
     success &= readRegisterWithRetry(REG06_CHARGE_VOLTAGE, reg06);
     success &= readRegisterWithRetry(REG04_CHARGE_CURRENT, reg04);
     success &= readRegisterWithRetry(REG11_VBUSV, reg11);
     success &= readRegisterWithRetry(REG12_ICHGR, reg12);
     
     if (!success) {
-        DEBUG_PRINTLN("ERROR: Failed to read critical registers");
+        BQ25895_LOGE(BQ25895_LOG_DIAG, "ERROR: Failed to read critical registers");
         return;
     }
     
-    DEBUG_PRINTF("System Status (REG0B): 0x%02X\n", reg0B);
-    DEBUG_PRINTF("  %s\n", decodeSystemStatus(reg0B).c_str());
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "System Status (REG0B): 0x%02X", reg0B);
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "  %s", decodeSystemStatus(reg0B).c_str());
     
-    DEBUG_PRINTF("Fault Status (REG0C): 0x%02X\n", reg0C);
-    DEBUG_PRINTF("  %s\n", decodeFaults(reg0C).c_str());
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "Fault Status (REG0C): 0x%02X", reg0C);
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "  %s", decodeFaults(reg0C).c_str());
     
     // Charge Voltage Configuration (REG06) - CRITICAL for BATOVP debugging
     uint16_t chargeVoltage = 3840 + (reg06 & 0x3F) * 16;
     uint16_t batovpThreshold = (chargeVoltage * 104) / 100; // 4% above VREG
-    DEBUG_PRINTF("Charge Voltage (REG06): 0x%02X (%dmV, BATOVP@%dmV)\n", 
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "Charge Voltage (REG06): 0x%02X (%dmV, BATOVP@%dmV)", 
                  reg06, chargeVoltage, batovpThreshold);
     
     // Charge Current Limit (REG04)
     uint16_t chargeCurrentLimit = (reg04 & 0x7F) * 64;
-    DEBUG_PRINTF("Charge Current Limit (REG04): 0x%02X (%dmA)\n", 
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "Charge Current Limit (REG04): 0x%02X (%dmA)", 
                  reg04, chargeCurrentLimit);
     
-    DEBUG_PRINTF("VBUS Voltage (REG11): 0x%02X (%.2fV)\n", 
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "VBUS Voltage (REG11): 0x%02X (%.2fV)", 
                  reg11, (2600 + (reg11 & 0x7F) * 100) / 1000.0);
     
-    DEBUG_PRINTF("Charge Current (REG12): 0x%02X (%dmA)\n", 
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "Charge Current (REG12): 0x%02X (%dmA)", 
                  reg12, (reg12 & 0x7F) * 50);
     
-    DEBUG_PRINTLN("=====================================");
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "=====================================");
 }
 
 bool BQ25895Driver::disableThermistorMonitoring() {
@@ -824,14 +2175,12 @@ BQ25895Driver::PowerTransition BQ25895Driver::detectVBusChanges() {
         lastVbusType_ = currentVbusType;
         lastVbusChangeTime_ = now;
         
-        logWithTimestamp(transition.changeDescription + " [Detection may be unreliable]");
+        BQ25895_LOGI(BQ25895_LOG_POWER, "%s [Detection may be unreliable]", transition.changeDescription.c_str());
     }
     
     return transition;
 }
 
-// Removed complex oscillation detection - let the BQ25895 work autonomously
-
 // Configuration and diagnostics
 BQ25895Config BQ25895Driver::getConfig() const {
     return config_;
@@ -881,31 +2230,32 @@ bool BQ25895Driver::performSelfTest() {
         return false;
     }
     
-    DEBUG_PRINTLN("Self test passed");
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "Self test passed");
     return true;
 }
 
 void BQ25895Driver::printRegisters() {
     if (!initialized_) {
-        DEBUG_PRINTLN("Driver not initialized");
+        BQ25895_LOGW(BQ25895_LOG_DIAG, "Driver not initialized");
         return;
     }
     
-    DEBUG_PRINTLN("=== BQ25895 REGISTER DUMP ===");
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "=== BQ25895 REGISTER DUMP ===");
     for (uint8_t reg = 0x00; reg <= 0x14; reg++) {
         uint8_t value;
         if (readRegisterWithRetry(reg, value)) {
-            DEBUG_PRINTF("REG%02X: 0x%02X (", reg, value);
-            // Print binary representation
+            // Binary representation
+            char bits[9];
             for (int i = 7; i >= 0; i--) {
-                DEBUG_PRINT(((value >> i) & 1) ? "1" : "0");
+                bits[7 - i] = ((value >> i) & 1) ? '1' : '0';
             }
-            DEBUG_PRINTLN(")");
+            bits[8] = '\0';
+            BQ25895_LOGI(BQ25895_LOG_DIAG, "REG%02X: 0x%02X (%s)", reg, value, bits);
         } else {
-            DEBUG_PRINTF("REG%02X: READ ERROR\n", reg);
+            BQ25895_LOGI(BQ25895_LOG_DIAG, "REG%02X: READ ERROR", reg);
         }
     }
-    DEBUG_PRINTLN("=============================");
+    BQ25895_LOGI(BQ25895_LOG_DIAG, "=============================");
 }
 
 // Register access (for advanced users)
@@ -936,16 +2286,18 @@ bool BQ25895Driver::writeRegisterWithRetry(uint8_t reg, uint8_t value, int maxRe
     
     for (int attempt = 0; attempt < maxRetries; attempt++) {
         uint8_t buffer[2] = {reg, value};
+        busTransactions_++;
         if (i2c_dev_->write(buffer, 2)) {
+            trackImageWrite(reg, value);
             if (attempt > 0) {
-                DEBUG_PRINTF("I2C Write succeeded on attempt %d: reg=0x%02X value=0x%02X\n", 
+                BQ25895_LOGT(BQ25895_LOG_I2C, "I2C Write succeeded on attempt %d: reg=0x%02X value=0x%02X", 
                             attempt + 1, reg, value);
             }
             return true;
         }
         
         if (attempt < maxRetries - 1) {
-            DEBUG_PRINTF("I2C Write retry %d/%d: reg=0x%02X error\n", 
+            BQ25895_LOGT(BQ25895_LOG_I2C, "I2C Write retry %d/%d: reg=0x%02X error", 
                         attempt + 1, maxRetries, reg);
             #if defined(ARDUINO)
             PLATFORM_DELAY(10); // Short delay between retries
@@ -954,7 +2306,8 @@ bool BQ25895Driver::writeRegisterWithRetry(uint8_t reg, uint8_t value, int maxRe
     }
     
     setError("I2C write failed after retries");
-    DEBUG_PRINTF("I2C Write FAILED after %d attempts: reg=0x%02X value=0x%02X\n", 
+    recordEvent(BQ25895EventCode::I2C_WRITE_FAILURE, reg);
+    BQ25895_LOGE(BQ25895_LOG_I2C, "I2C Write FAILED after %d attempts: reg=0x%02X value=0x%02X", 
                 maxRetries, reg, value);
     return false;
 }
@@ -966,16 +2319,18 @@ bool BQ25895Driver::readRegisterWithRetry(uint8_t reg, uint8_t& value, int maxRe
     }
     
     for (int attempt = 0; attempt < maxRetries; attempt++) {
+        busTransactions_++;
         if (i2c_dev_->write_then_read(&reg, 1, &value, 1)) {
+            observeRegisterRead(reg, value);
             if (attempt > 0) {
-                DEBUG_PRINTF("I2C Read succeeded on attempt %d: reg=0x%02X value=0x%02X\n", 
+                BQ25895_LOGT(BQ25895_LOG_I2C, "I2C Read succeeded on attempt %d: reg=0x%02X value=0x%02X", 
                             attempt + 1, reg, value);
             }
             return true;
         }
         
         if (attempt < maxRetries - 1) {
-            DEBUG_PRINTF("I2C Read retry %d/%d: reg=0x%02X error\n", 
+            BQ25895_LOGT(BQ25895_LOG_I2C, "I2C Read retry %d/%d: reg=0x%02X error", 
                         attempt + 1, maxRetries, reg);
             #if defined(ARDUINO)
             PLATFORM_DELAY(10); // Short delay between retries
@@ -984,7 +2339,8 @@ bool BQ25895Driver::readRegisterWithRetry(uint8_t reg, uint8_t& value, int maxRe
     }
     
     setError("I2C read failed after retries");
-    DEBUG_PRINTF("I2C Read FAILED after %d attempts: reg=0x%02X\n", maxRetries, reg);
+    recordEvent(BQ25895EventCode::I2C_READ_FAILURE, reg);
+    BQ25895_LOGE(BQ25895_LOG_I2C, "I2C Read FAILED after %d attempts: reg=0x%02X", maxRetries, reg);
     return false;
 }
 
@@ -1001,7 +2357,7 @@ bool BQ25895Driver::updateRegisterBits(uint8_t reg, uint8_t mask, uint8_t value)
     if (newValue != currentValue) {
         bool writeSuccess = writeRegisterWithRetry(reg, newValue, 2);
         if (writeSuccess) {
-            DEBUG_PRINTF("Bit update: reg=0x%02X, mask=0x%02X, old=0x%02X, new=0x%02X\n", 
+            BQ25895_LOGD(BQ25895_LOG_I2C, "Bit update: reg=0x%02X, mask=0x%02X, old=0x%02X, new=0x%02X", 
                         reg, mask, currentValue, newValue);
         }
         return writeSuccess;
@@ -1010,39 +2366,220 @@ bool BQ25895Driver::updateRegisterBits(uint8_t reg, uint8_t mask, uint8_t value)
     return true; // No change needed
 }
 
-void BQ25895Driver::setError(const String& error) {
-    lastError_ = error;
-    #if defined(ARDUINO)
-    if (error.length() > 0) {
-        DEBUG_PRINTF("BQ25895Driver Error: %s\n", error.c_str());
+bool BQ25895Driver::writeRegisterBurst(uint8_t startReg, const uint8_t* values, uint8_t count, int maxRetries) {
+    if (!i2c_dev_) {
+        setError("I2C device not available");
+        return false;
     }
-    #else
-    if (error.length() > 0) {
-        DEBUG_PRINTF("BQ25895Driver Error: %s\n", error.c_str());
+    
+    // Multi-write: register address followed by consecutive values (auto-increment)
+    uint8_t buffer[BQ25895RegisterImage::kBurstLength + 1];
+    if (count == 0 || count > BQ25895RegisterImage::kBurstLength) {
+        setError("Invalid burst length");
+        return false;
     }
-    #endif
+    buffer[0] = startReg;
+    for (uint8_t i = 0; i < count; i++) {
+        buffer[i + 1] = values[i];
+    }
+    
+    for (int attempt = 0; attempt < maxRetries; attempt++) {
+        busTransactions_++;
+        if (i2c_dev_->write(buffer, count + 1)) {
+            for (uint8_t i = 0; i < count; i++) {
+                trackImageWrite(startReg + i, values[i]);
+            }
+            return true;
+        }
+        
+        if (attempt < maxRetries - 1) {
+            BQ25895_LOGT(BQ25895_LOG_I2C, "I2C Burst write retry %d/%d: reg=0x%02X len=%d", 
+                        attempt + 1, maxRetries, startReg, count);
+            #if defined(ARDUINO)
+            PLATFORM_DELAY(10); // Short delay between retries
+            #endif
+        }
+    }
+    
+    setError("I2C burst write failed after retries");
+    recordEvent(BQ25895EventCode::I2C_WRITE_FAILURE, startReg);
+    return false;
 }
 
-String BQ25895Driver::formatTimestamp(unsigned long timestamp) {
-    unsigned long seconds = timestamp / 1000;
-    unsigned long hours = seconds / 3600;
-    unsigned long minutes = (seconds % 3600) / 60;
-    seconds = seconds % 60;
+bool BQ25895Driver::readRegisterBurst(uint8_t startReg, uint8_t* values, uint8_t count, int maxRetries) {
+    if (!i2c_dev_) {
+        setError("I2C device not available");
+        return false;
+    }
     
-    #if defined(ARDUINO)
-    char buffer[16];
-    snprintf(buffer, sizeof(buffer), "[%02lu:%02lu:%02lu]", hours, minutes, seconds);
-    return String(buffer);
-    #else
-    char buffer[16];
-    snprintf(buffer, sizeof(buffer), "[%02lu:%02lu:%02lu]", hours, minutes, seconds);
-    return std::string(buffer);
-    #endif
+    for (int attempt = 0; attempt < maxRetries; attempt++) {
+        busTransactions_++;
+        if (i2c_dev_->write_then_read(&startReg, 1, values, count)) {
+            return true;
+        }
+        
+        if (attempt < maxRetries - 1) {
+            BQ25895_LOGT(BQ25895_LOG_I2C, "I2C Burst read retry %d/%d: reg=0x%02X len=%d", 
+                        attempt + 1, maxRetries, startReg, count);
+            #if defined(ARDUINO)
+            PLATFORM_DELAY(10); // Short delay between retries
+            #endif
+        }
+    }
+    
+    setError("I2C burst read failed after retries");
+    recordEvent(BQ25895EventCode::I2C_READ_FAILURE, startReg);
+    return false;
+}
+
+bool BQ25895Driver::writeRegisterImage(const BQ25895RegisterImage& image) {
+    if (!writeRegisterBurst(BQ25895RegisterImage::kBurstStart, image.burst,
+                            BQ25895RegisterImage::kBurstLength)) {
+        return false;
+    }
+    return writeRegisterWithRetry(REG0D_VINDPM, image.vindpm);
+}
+
+bool BQ25895Driver::readFaults(uint8_t& value) {
+    // REG0C latches the first fault until read; one read per poll is enough
+    // because the accumulator keeps every latched bit
+    if (!readRegisterWithRetry(REG0C_FAULT, value)) {
+        return false;
+    }
+    
+    unsigned long now = millis();
+    uint8_t categories = categorizeFaults(value);
+    bool changed = (value != faults_.lastRaw);
+    faults_.lastRaw = value;
+    faults_.current = categories;
+    faults_.unacknowledged |= categories;
+    faults_.sinceBoot |= categories;
+    if (categories & BQ25895FaultMask(BQ25895Fault::WATCHDOG)) {
+        watchdogExpired_ = true;
+    }
+    for (uint8_t i = 0; i < BQ25895_FAULT_CATEGORIES; i++) {
+        if (categories & (1u << i)) {
+            BQ25895FaultRecord& record = faults_.records[i];
+            if (record.count < 0xFFFF) record.count++;
+            if (record.firstSeen == 0) record.firstSeen = now;
+            record.lastSeen = now;
+        }
+    }
+    
+    sessions_.noteFaults(categories);
+    
+    // Persistent faults are logged once, not on every poll
+    if (value != 0 && changed) {
+        recordEvent(BQ25895EventCode::FAULT, categories);
+    }
+    return true;
+}
+
+void BQ25895Driver::observeRegisterRead(uint8_t reg, uint8_t value) {
+    if (reg == REG09_NEW_FAULT) {
+        lastReg09_ = value;
+    } else if (reg == REG0B_SYSTEM_STATUS) {
+        // Every REG0B read doubles as VBUS transition detection for the event history
+        VBusType previous = static_cast<VBusType>((lastReg0B_ & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT);
+        VBusType current = static_cast<VBusType>((value & VBUS_STAT_MASK) >> VBUS_STAT_SHIFT);
+        if (oscillation_.observe(millis(), lastReg0B_, value)) {
+            oscillationPending_ = true;  // Mitigated from getStatus(), outside the read path
+        }
+        lastReg0B_ = value;
+        if (current != previous) {
+            if (previous == VBusType::NONE) {
+                recordEvent(BQ25895EventCode::VBUS_ATTACH, static_cast<uint8_t>(current));
+            } else if (current == VBusType::NONE) {
+                recordEvent(BQ25895EventCode::VBUS_DETACH, static_cast<uint8_t>(previous));
+            } else {
+                recordEvent(BQ25895EventCode::VBUS_CHANGE, static_cast<uint8_t>(current));
+            }
+        }
+    }
+}
+
+void BQ25895Driver::recordEvent(BQ25895EventCode code, uint8_t detail) {
+    events_.record(code, detail, lastReg0B_, faults_.lastRaw, lastReg09_, millis());
 }
 
-void BQ25895Driver::logWithTimestamp(const String& message) {
-    String timestamp = formatTimestamp(millis());
-    DEBUG_PRINTF("%s >>> %s\n", timestamp.c_str(), message.c_str());
+void BQ25895Driver::trackImageWrite(uint8_t reg, uint8_t value) {
+    if (reg == REG09_NEW_FAULT) {
+        lastReg09_ = value;
+    }
+    
+    // Anything the driver writes becomes the expected state for drift detection
+    // (FORCE_DPDM is a one-shot command, not configuration)
+    if (reg == REG02_ADC_CONTROL) {
+        value &= ~REG02_FORCE_DPDM;
+    }
+    if (reg < BQ25895RegisterImage::kBurstLength) {
+        image_.burst[reg] = value;
+    } else if (reg == REG0D_VINDPM) {
+        image_.vindpm = value;
+    }
+}
+
+bool BQ25895Driver::reconcileImage(const uint8_t* snapshot, uint8_t vindpm, bool repair,
+                                   uint8_t& diverged, uint16_t& divergedMask) {
+    // Find the span of registers that diverge from the image
+    int first = -1;
+    int last = -1;
+    diverged = 0;
+    divergedMask = 0;
+    for (uint8_t reg = 0; reg < BQ25895RegisterImage::kBurstLength; reg++) {
+        uint8_t mask = BQ25895ImageCompareMask(reg);
+        if ((snapshot[reg] & mask) != (image_.burst[reg] & mask)) {
+            if (first < 0) first = reg;
+            last = reg;
+            diverged++;
+            divergedMask |= (1u << reg);
+        }
+    }
+    bool vindpmDiverged = (vindpm != image_.vindpm);
+    if (vindpmDiverged) {
+        diverged++;
+        divergedMask |= (1u << REG0D_VINDPM);
+    }
+    
+    if (!repair) {
+        return true;
+    }
+    
+    // Reprogram the diverged span as a single burst (copy: the write re-tracks the image)
+    if (first >= 0) {
+        uint8_t values[BQ25895RegisterImage::kBurstLength];
+        for (int reg = first; reg <= last; reg++) {
+            values[reg - first] = image_.burst[reg];
+        }
+        if (!writeRegisterBurst(first, values, last - first + 1)) {
+            setError("Failed to repair configuration registers");
+            return false;
+        }
+    }
+    if (vindpmDiverged && !writeRegisterWithRetry(REG0D_VINDPM, image_.vindpm)) {
+        setError("Failed to set VINDPM threshold");
+        return false;
+    }
+    
+    return true;
+}
+
+void BQ25895Driver::setError(const String& error) {
+    lastError_ = error;
+    if (error.length() > 0) {
+        BQ25895_LOGE(BQ25895_LOG_CORE, "BQ25895Driver Error: %s", error.c_str());
+    }
+}
+
+void BQ25895Driver::logWithTimestamp(const char* message) {
+    // Formatted in place: no temporary Strings, nothing at all when INFO is compiled out
+#if BQ25895_LOG_LEVEL >= BQ25895_LOG_LEVEL_INFO
+    unsigned long seconds = millis() / 1000;
+    BQ25895_LOGI(BQ25895_LOG_POWER, "[%02lu:%02lu:%02lu] >>> %s",
+                 seconds / 3600, (seconds % 3600) / 60, seconds % 60, message);
+#else
+    (void)message;
+#endif
 }
 
 bool BQ25895Driver::verifyDevice() {
@@ -1059,7 +2596,7 @@ bool BQ25895Driver::verifyDevice() {
     
     uint8_t vendorId = (vendorReg >> 3) & 0x1F;
     uint8_t partNumber = vendorReg & 0x07;
-    DEBUG_PRINTF("BQ25895 Vendor ID: 0x%02X, Part Number: 0x%02X\n", vendorId, partNumber);
+    BQ25895_LOGD(BQ25895_LOG_INIT, "BQ25895 Vendor ID: 0x%02X, Part Number: 0x%02X", vendorId, partNumber);
     
     // Basic sanity check - vendor ID should be non-zero
     if (vendorId == 0 || vendorId == 0x1F) {
@@ -1197,48 +2734,91 @@ String BQ25895Driver::getRegisterDiagnostics() {
     return diagnostics;
 }
 
-// Advanced control functions (moved from main.cpp)
+void BQ25895Driver::setDriftCheckInterval(unsigned long intervalMs) {
+    driftCheckIntervalMs_ = intervalMs;
+    lastDriftCheck_ = millis();
+}
 
-bool BQ25895Driver::repairRegisters() {
+bool BQ25895Driver::pollDriftMonitor() {
+    if (!initialized_ || driftCheckIntervalMs_ == 0) {
+        return true;
+    }
+    
+    unsigned long now = millis();
+    if (now - lastDriftCheck_ < driftCheckIntervalMs_) {
+        return true; // Not due yet
+    }
+    lastDriftCheck_ = now;
+    
+    return checkRegisterDrift(true);
+}
+
+bool BQ25895Driver::checkRegisterDrift(bool repair) {
     if (!initialized_) {
-        lastError_ = "Driver not initialized";
+        setError("Driver not initialized");
         return false;
     }
     
-    bool success = true;
+    // Cheap snapshot: one burst for REG00-REG07 and a single REG0D read, plus REG0C
+    // through the fault accumulator so no latched fault is lost to the check
+    uint8_t snapshot[BQ25895RegisterImage::kBurstLength];
+    uint8_t vindpm;
+    uint8_t reg0C;
+    if (!readRegisterBurst(REG00_INPUT_CURRENT, snapshot, sizeof(snapshot)) ||
+        !readRegisterWithRetry(REG0D_VINDPM, vindpm) ||
+        !readFaults(reg0C)) {
+        setError("Drift check failed - cannot read configuration");
+        return false;
+    }
+    driftStats_.checks++;
     
-    // Fix REG02 - Charge Current (1000mA = 1000/64 = 15.6, use 16 = 0x10)
-    uint8_t chgCurrent = 16; // 16 * 64mA = 1024mA ≈ 1000mA
-    if (writeRegister(0x02, chgCurrent)) {
-        // Success will be logged by caller
-    } else {
-        success = false;
+    // Classify before repairing (the repair updates nothing in the snapshot). A watchdog
+    // expiry may have been latched by an earlier fault poll, so the flag is used, not reg0C
+    BQ25895DriftCause cause = BQ25895DriftCause::FIELD_CHANGE;
+    if ((image_.vindpm & 0x80) && !(vindpm & 0x80)) {
+        cause = BQ25895DriftCause::REGISTER_RESET; // FORCE_VINDPM only clears on REG_RST/POR
+    } else if (watchdogExpired_) {
+        cause = BQ25895DriftCause::WATCHDOG_RESET;
     }
+    watchdogExpired_ = false;
     
-    // Fix REG06 - Charge Voltage (4192mV for safety)
-    uint8_t reg06;
-    if (readRegister(0x06, reg06)) {
-        uint8_t voltageField = 22; // 22 * 16 + 3840 = 4192mV (safe for 4.16V battery)
-        reg06 = (reg06 & 0x03) | (voltageField << 2); // Keep lower 2 bits, set voltage
-        if (!writeRegister(0x06, reg06)) {
-            success = false;
-        }
-    } else {
-        success = false;
+    uint8_t diverged;
+    uint16_t divergedMask;
+    bool success = reconcileImage(snapshot, vindpm, repair, diverged, divergedMask);
+    
+    if (diverged == 0) {
+        return success;
     }
     
-    // Fix REG00 - Input Current (1500mA = (1500-100)/50 = 28 = 0x1C)
-    uint8_t inputField = 28; // 28 * 50 + 100 = 1500mA
-    uint8_t reg00;
-    if (readRegister(0x00, reg00)) {
-        reg00 = (reg00 & 0xC0) | inputField; // Keep upper 2 bits, set input limit
-        if (!writeRegister(0x00, reg00)) {
-            success = false;
-        }
-    } else {
-        success = false;
+    driftStats_.driftEvents++;
+    driftStats_.lastDivergedMask = divergedMask;
+    driftStats_.lastCause = cause;
+    driftStats_.lastDriftTime = millis();
+    recordEvent(BQ25895EventCode::REGISTER_DRIFT, static_cast<uint8_t>(cause));
+    if (cause == BQ25895DriftCause::REGISTER_RESET) driftStats_.registerResets++;
+    if (cause == BQ25895DriftCause::WATCHDOG_RESET) driftStats_.watchdogResets++;
+    if (repair && success) driftStats_.registersRepaired += diverged;
+    
+    BQ25895_LOGW(BQ25895_LOG_FAULT, "Register drift detected (cause=%d, mask=0x%04X)%s",
+                 static_cast<int>(cause), divergedMask, repair ? " - repaired" : "");
+    
+    return success && repair;
+}
+
+BQ25895DriftStats BQ25895Driver::getDriftStats() const {
+    return driftStats_;
+}
+
+// Advanced control functions (moved from main.cpp)
+
+bool BQ25895Driver::repairRegisters() {
+    if (!initialized_) {
+        lastError_ = "Driver not initialized";
+        return false;
     }
     
+    // Rewrite only the registers that no longer match the configured image
+    bool success = checkRegisterDrift(true);
     if (!success) {
         lastError_ = "One or more register repairs failed";
     }
@@ -1273,41 +2853,41 @@ bool BQ25895Driver::forceEnableBATFET() {
 }
 
 bool BQ25895Driver::forceRestartCharging() {
+    return startForceRestartCharging() && finishProcedure();
+}
+
+bool BQ25895Driver::startForceRestartCharging() {
     if (!initialized_) {
-        lastError_ = "Driver not initialized";
-        return false;
-    }
-    
-    // Disable charging first
-    if (!disableCharging()) {
-        return false;
-    }
-    PLATFORM_DELAY(100);
-    
-    // Enhanced DPM defeat during restart
-    // Force input current limit via direct register write
-    if (!writeRegister(0x00, 0x1C)) { // 1500mA
-        lastError_ = "Failed to set input current limit";
+        setError("Driver not initialized");
         return false;
     }
-    
-    // Disable USB auto-detection that keeps overriding us
-    uint8_t reg0D;
-    if (readRegister(0x0D, reg0D)) {
-        reg0D |= 0x80; // Set FORCE_DPDM bit
-        writeRegister(0x0D, reg0D);
-    }
-    
-    // Re-enable charging (this should reset the completion status)
-    if (!enableCharging()) {
-        return false;
+    return startProcedure(BQ25895ProcedureId::FORCE_RESTART_CHARGING, 1000);
+}
+
+BQ25895StepResult BQ25895Driver::forceRestartChargingStep(uint8_t step) {
+    switch (step) {
+        case 0:
+            // Disable charging first, then let the charger settle
+            if (!disableCharging()) {
+                return BQ25895StepResult::fail("Failed to disable charging");
+            }
+            return BQ25895StepResult::next(100);
+        case 1:
+            // Input limit back up before charging resumes (EN_HIZ is kept).
+            // REG0D needs no write: the register image always holds FORCE_VINDPM, so the
+            // absolute VINDPM is not overridden by input detection.
+            if (!setInputCurrentLimit(1500)) {
+                return BQ25895StepResult::fail("Failed to set input current limit");
+            }
+            return BQ25895StepResult::next();
+        default:
+            // Re-enable charging (this should reset the completion status)
+            if (!enableCharging()) {
+                return BQ25895StepResult::fail("Failed to re-enable charging");
+            }
+            setTerminationCurrent(64);
+            return BQ25895StepResult::done();
     }
-    
-    // Re-apply our current limits multiple ways to ensure they stick
-    setInputCurrentLimit(1500);
-    setTerminationCurrent(64);
-    
-    return true;
 }
 
 String BQ25895Driver::getChargeVoltageAnalysis() {
@@ -1354,9 +2934,9 @@ bool BQ25895Driver::checkVoltageSafety() {
         if (voltageSafe_) {
             // First time detecting unsafe voltage
             voltageSafe_ = false;
-            DEBUG_PRINTF("🚨 VOLTAGE SAFETY TRIGGERED: Input %dmV > %dmV limit\n", 
+            BQ25895_LOGE(BQ25895_LOG_SAFETY, "🚨 VOLTAGE SAFETY TRIGGERED: Input %dmV > %dmV limit", 
                         metrics.inputVoltage, config_.voltageSafetyLimitMV);
-            DEBUG_PRINTLN("   LEDs at risk! Initiating emergency shutdown...");
+            BQ25895_LOGE(BQ25895_LOG_SAFETY, "   LEDs at risk! Initiating emergency shutdown...");
             
             // Trigger immediate protective shutdown
             forceEmergencyShutdown();
@@ -1379,13 +2959,14 @@ bool BQ25895Driver::forceEmergencyShutdown() {
     }
     
     emergencyShutdownTriggered_ = true;
-    DEBUG_PRINTLN("🚨 EMERGENCY SHUTDOWN: Protecting system from overvoltage");
+    recordEvent(BQ25895EventCode::SAFETY_SHUTDOWN);
+    BQ25895_LOGE(BQ25895_LOG_SAFETY, "🚨 EMERGENCY SHUTDOWN: Protecting system from overvoltage");
     
     bool success = true;
     
     // 1. Disable charging immediately
     if (!disableCharging()) {
-        DEBUG_PRINTLN("   ⚠️ Failed to disable charging during emergency shutdown");
+        BQ25895_LOGW(BQ25895_LOG_SAFETY, "   ⚠️ Failed to disable charging during emergency shutdown");
         success = false;
     }
     
@@ -1394,26 +2975,26 @@ bool BQ25895Driver::forceEmergencyShutdown() {
     if (readRegisterWithRetry(REG09_NEW_FAULT, reg09)) {
         reg09 |= 0x20; // Set BATFET_DIS bit
         if (!writeRegisterWithRetry(REG09_NEW_FAULT, reg09)) {
-            DEBUG_PRINTLN("   ⚠️ Failed to disable BATFET during emergency shutdown");
+            BQ25895_LOGW(BQ25895_LOG_SAFETY, "   ⚠️ Failed to disable BATFET during emergency shutdown");
             success = false;
         } else {
-            DEBUG_PRINTLN("   ✓ BATFET disabled for protection");
+            BQ25895_LOGI(BQ25895_LOG_SAFETY, "   ✓ BATFET disabled for protection");
         }
     }
     
     // 3. Set input current limit to minimum
     if (!setInputCurrentLimit(100)) {
-        DEBUG_PRINTLN("   ⚠️ Failed to limit input current during emergency shutdown");
+        BQ25895_LOGW(BQ25895_LOG_SAFETY, "   ⚠️ Failed to limit input current during emergency shutdown");
         success = false;
     } else {
-        DEBUG_PRINTLN("   ✓ Input current limited to 100mA");
+        BQ25895_LOGI(BQ25895_LOG_SAFETY, "   ✓ Input current limited to 100mA");
     }
     
     if (success) {
-        DEBUG_PRINTLN("   ✓ Emergency shutdown completed successfully");
-        DEBUG_PRINTLN("   💡 SOLUTION: Reduce external VIN to ≤5.5V and restart system");
+        BQ25895_LOGI(BQ25895_LOG_SAFETY, "   ✓ Emergency shutdown completed successfully");
+        BQ25895_LOGI(BQ25895_LOG_SAFETY, "   💡 SOLUTION: Reduce external VIN to ≤5.5V and restart system");
     } else {
-        DEBUG_PRINTLN("   ⚠️ Emergency shutdown completed with some failures");
+        BQ25895_LOGW(BQ25895_LOG_SAFETY, "   ⚠️ Emergency shutdown completed with some failures");
     }
     
     return success;
@@ -25,10 +25,27 @@
   typedef std::string String; // For compatibility
 #endif
 
+#include "BQ25895EventHistory.h"
+#include "BQ25895SocEstimator.h"
+#include "BQ25895ChargePredictor.h"
+#include "BQ25895HealthEstimator.h"
+#include "BQ25895SessionTracker.h"
+#include "BQ25895ThermalGovernor.h"
+#include "BQ25895StepProfile.h"
+#include "BQ25895TempZones.h"
+#include "BQ25895PowerBudget.h"
+#include "BQ25895BrownoutPredictor.h"
+#include "BQ25895OscillationDetector.h"
+#include "BQ25895VindpmTracker.h"
+#include "BQ25895PowerFlow.h"
+#include "BQ25895Procedure.h"
+
 // BQ25895 Register Definitions
 #define BQ25895_I2C_ADDR 0x6A
 
 #define REG00_INPUT_CURRENT 0x00
+#define REG01_VINDPM_OFFSET 0x01
+#define REG02_ADC_CONTROL 0x02
 #define REG03_CHARGE_CONFIG 0x03
 #define REG04_CHARGE_CURRENT 0x04
 #define REG05_TIMER 0x05
@@ -60,6 +77,38 @@
 #define WATCHDOG_80S 0x02
 #define WATCHDOG_160S 0x03
 
+// Input Current Optimizer (REG02 ICO_EN, REG09 FORCE_ICO, REG13 IDPM_LIM, REG14 ICO_OPTIMIZED)
+#define REG02_CONV_START 0x80
+#define REG02_ICO_EN 0x10
+#define REG09_FORCE_ICO 0x80
+#define REG13_IDPM_LIM_MASK 0x3F
+#define REG14_ICO_OPTIMIZED 0x40
+#define BQ25895_ICO_TIMEOUT_MS 3000
+
+// Power path (REG00 EN_HIZ, REG03 CHG_CONFIG)
+#define REG00_EN_HIZ 0x80
+#define REG03_CHG_CONFIG 0x10
+
+// Input regulation status (REG13)
+#define REG13_VDPM_STAT 0x80
+#define REG13_IDPM_STAT 0x40
+
+// High-voltage adapter negotiation (REG02 HVDCP_EN/MAXC_EN, REG04 EN_PUMPX, REG09 PUMPX_UP/DN)
+#define REG02_HVDCP_EN 0x08
+#define REG02_MAXC_EN 0x04
+#define REG02_FORCE_DPDM 0x02
+#define REG04_EN_PUMPX 0x80
+#define REG09_PUMPX_UP 0x02
+#define REG09_PUMPX_DN 0x01
+#define BQ25895_ADC_CONVERSION_MS 20
+#define BQ25895_HV_MIN_RISE_MV 300
+#define BQ25895_HV_TIMEOUT_MS 10000
+
+// USB recovery: FORCE_DPDM re-detection attempts before escalating to a full reset
+#define BQ25895_DPDM_ATTEMPTS 2
+#define BQ25895_DPDM_TIMEOUT_MS 1000
+#define BQ25895_DPDM_POLL_MS 20
+
 // VBUS Input Types
 enum class VBusType : uint8_t {
   NONE = 0,           // No Input
@@ -99,6 +148,23 @@ private:
 };
 #endif
 
+// Fault categories decoded from REG0C (bit positions in fault category masks)
+enum class BQ25895Fault : uint8_t {
+  WATCHDOG = 0,        // REG0C[7] watchdog expiry
+  BOOST = 1,           // REG0C[6] OTG overload/OVP/low battery
+  CHARGE_INPUT = 2,    // REG0C[5:4] = 01 input fault
+  CHARGE_THERMAL = 3,  // REG0C[5:4] = 10 thermal shutdown
+  CHARGE_TIMER = 4,    // REG0C[5:4] = 11 safety timer expiration
+  BATTERY_OVP = 5,     // REG0C[3] BATOVP
+  NTC_COLD = 6,        // REG0C[2:0] = x01 TS cold (buck or boost)
+  NTC_HOT = 7          // REG0C[2:0] = x10 TS hot (buck or boost)
+};
+#define BQ25895_FAULT_CATEGORIES 8
+
+constexpr uint8_t BQ25895FaultMask(BQ25895Fault fault) {
+  return static_cast<uint8_t>(1u << static_cast<uint8_t>(fault));
+}
+
 // Configuration structure
 struct BQ25895Config {
   uint16_t inputCurrentMA = 1500;      // Input current limit (mA)
@@ -109,68 +175,184 @@ struct BQ25895Config {
   uint16_t voltageSafetyLimitMV = 5500; // Voltage safety limit for emergency shutdown (mV)
   bool disableWatchdog = true;         // Disable I2C watchdog
   bool disableSafetyTimer = true;      // Disable safety timer for testing
+  
+  BQ25895Config() = default;
+  
+  // Field-by-field constructor so presets can be evaluated at compile time
+  constexpr BQ25895Config(uint16_t inputMA, uint16_t chargeMA, uint16_t chargeMV,
+                          uint16_t terminationMA, uint16_t vindpmMV, uint16_t safetyLimitMV,
+                          bool noWatchdog, bool noSafetyTimer)
+    : inputCurrentMA(inputMA), chargeCurrentMA(chargeMA), chargeVoltageNV(chargeMV),
+      terminationCurrentMA(terminationMA), vindpmThresholdMV(vindpmMV),
+      voltageSafetyLimitMV(safetyLimitMV), disableWatchdog(noWatchdog),
+      disableSafetyTimer(noSafetyTimer) {}
 };
 
 // Configuration presets for common applications
+// All presets are constexpr so they can be compiled into a BQ25895RegisterImage
 class BQ25895ConfigPresets {
 public:
   // LED Driver configuration with 5.5V safety limit
-  static BQ25895Config LEDDriver() {
-    BQ25895Config config;
-    config.inputCurrentMA = 1500;          // Conservative input current
-    config.chargeCurrentMA = 1000;         // 1A charging
-    config.chargeVoltageNV = 4192;         // Conservative 4.192V
-    config.terminationCurrentMA = 64;      // Low termination current
-    config.vindpmThresholdMV = 4400;       // 4.4V VINDPM
-    config.voltageSafetyLimitMV = 5500;    // 5.5V LED safety limit
-    config.disableWatchdog = true;         // Disable for development
-    config.disableSafetyTimer = false;     // Keep safety timer
-    return config;
+  static constexpr BQ25895Config LEDDriver() {
+    return BQ25895Config(
+      1500,    // Conservative input current
+      1000,    // 1A charging
+      4192,    // Conservative 4.192V
+      64,      // Low termination current
+      4400,    // 4.4V VINDPM
+      5500,    // 5.5V LED safety limit
+      true,    // Disable watchdog for development
+      false);  // Keep safety timer
   }
   
   // Portable device configuration
-  static BQ25895Config PortableDevice() {
-    BQ25895Config config;
-    config.inputCurrentMA = 2000;          // Higher input current
-    config.chargeCurrentMA = 1500;         // Faster charging
-    config.chargeVoltageNV = 4208;         // Higher voltage for capacity
-    config.terminationCurrentMA = 128;     // Standard termination
-    config.vindpmThresholdMV = 4600;       // Higher VINDPM
-    config.voltageSafetyLimitMV = 6000;    // Higher safety limit
-    config.disableWatchdog = false;        // Enable watchdog
-    config.disableSafetyTimer = false;     // Keep safety timer
-    return config;
+  static constexpr BQ25895Config PortableDevice() {
+    return BQ25895Config(
+      2000,    // Higher input current
+      1500,    // Faster charging
+      4208,    // Higher voltage for capacity
+      128,     // Standard termination
+      4600,    // Higher VINDPM
+      6000,    // Higher safety limit
+      false,   // Enable watchdog
+      false);  // Keep safety timer
   }
   
   // Fast charging configuration
-  static BQ25895Config FastCharging() {
-    BQ25895Config config;
-    config.inputCurrentMA = 3000;          // Maximum input current
-    config.chargeCurrentMA = 2000;         // High charge current
-    config.chargeVoltageNV = 4208;         // Full voltage
-    config.terminationCurrentMA = 256;     // Higher termination
-    config.vindpmThresholdMV = 4600;       // High VINDPM
-    config.voltageSafetyLimitMV = 6000;    // Standard safety limit
-    config.disableWatchdog = false;        // Enable watchdog
-    config.disableSafetyTimer = false;     // Keep safety timer
-    return config;
+  static constexpr BQ25895Config FastCharging() {
+    return BQ25895Config(
+      3000,    // Maximum input current
+      2000,    // High charge current
+      4208,    // Full voltage
+      256,     // Higher termination
+      4600,    // High VINDPM
+      6000,    // Standard safety limit
+      false,   // Enable watchdog
+      false);  // Keep safety timer
   }
   
   // Lab testing configuration with debugging features
-  static BQ25895Config LabTesting() {
-    BQ25895Config config;
-    config.inputCurrentMA = 500;           // Low current for safety
-    config.chargeCurrentMA = 500;          // Low charge current
-    config.chargeVoltageNV = 4100;         // Conservative voltage
-    config.terminationCurrentMA = 64;      // Low termination
-    config.vindpmThresholdMV = 4000;       // Low VINDPM
-    config.voltageSafetyLimitMV = 5000;    // Low safety limit
-    config.disableWatchdog = true;         // Disable for debugging
-    config.disableSafetyTimer = true;      // Disable for testing
-    return config;
+  static constexpr BQ25895Config LabTesting() {
+    return BQ25895Config(
+      500,     // Low current for safety
+      500,     // Low charge current
+      4100,    // Conservative voltage
+      64,      // Low termination
+      4000,    // Low VINDPM
+      5000,    // Low safety limit
+      true,    // Disable for debugging
+      true);   // Disable for testing
   }
 };
 
+// Register field encoding (constexpr, shared by the setters and the register image)
+// Every encoder clamps to the datasheet range; BQ25895Limits reports whether clamping was needed.
+namespace BQ25895Encode {
+  // REG00[5:0] IINLIM: 100mA offset, 50mA step, 3.25A max
+  constexpr uint8_t inputCurrent(uint16_t mA) {
+    return mA <= 100 ? 0x00 : (mA >= 3250 ? 0x3F : static_cast<uint8_t>((mA - 100) / 50));
+  }
+  // REG04[6:0] ICHG: 64mA step, 5.056A max
+  constexpr uint8_t chargeCurrent(uint16_t mA) {
+    return mA >= 5056 ? 0x4F : static_cast<uint8_t>(mA / 64);
+  }
+  // REG06[7:2] VREG: 3.840V offset, 16mV step, 4.608V max
+  constexpr uint8_t chargeVoltage(uint16_t mV) {
+    return mV <= 3840 ? 0x00 : (mV >= 4608 ? 0x30 : static_cast<uint8_t>((mV - 3840) / 16));
+  }
+  // REG05[3:0] ITERM: 64mA offset, 64mA step, 1.024A max
+  constexpr uint8_t terminationCurrent(uint16_t mA) {
+    return mA <= 64 ? 0x00 : (mA >= 1024 ? 0x0F : static_cast<uint8_t>((mA - 64) / 64));
+  }
+  // REG0D[6:0] VINDPM: 2.6V offset, 100mV step, 3.9V-15.3V
+  constexpr uint8_t vindpm(uint16_t mV) {
+    return mV <= 3900 ? 0x0D : (mV >= 15300 ? 0x7F : static_cast<uint8_t>((mV - 2600) / 100));
+  }
+}
+
+// Datasheet ranges for compile-time validation of configurations
+namespace BQ25895Limits {
+  constexpr bool inputCurrentValid(uint16_t mA) { return mA >= 100 && mA <= 3250; }
+  constexpr bool chargeCurrentValid(uint16_t mA) { return mA <= 5056; }
+  constexpr bool chargeVoltageValid(uint16_t mV) { return mV >= 3840 && mV <= 4608; }
+  constexpr bool terminationCurrentValid(uint16_t mA) { return mA >= 64 && mA <= 1024; }
+  constexpr bool vindpmValid(uint16_t mV) { return mV >= 3900 && mV <= 15300; }
+  
+  constexpr bool configValid(const BQ25895Config& c) {
+    return inputCurrentValid(c.inputCurrentMA) && chargeCurrentValid(c.chargeCurrentMA) &&
+           chargeVoltageValid(c.chargeVoltageNV) && terminationCurrentValid(c.terminationCurrentMA) &&
+           vindpmValid(c.vindpmThresholdMV);
+  }
+}
+
+// Pre-built register image for a configuration
+// REG00-REG07 are written as a single multi-write burst (datasheet 8.2.16.7),
+// REG0D (absolute VINDPM) is written separately because REG08-REG0C are not ours to write.
+struct BQ25895RegisterImage {
+  static constexpr uint8_t kBurstStart = REG00_INPUT_CURRENT;
+  static constexpr uint8_t kBurstLength = 8; // REG00 through REG07
+  
+  uint8_t burst[kBurstLength];
+  uint8_t vindpm;
+  
+  // Build the image for a configuration. Unconfigured fields use the values the
+  // driver has always programmed (REG02 ADC start, REG03 charge enabled with OTG off)
+  // or the datasheet power-on defaults.
+  static constexpr BQ25895RegisterImage compile(const BQ25895Config& c) {
+    return BQ25895RegisterImage{
+      {
+        BQ25895Encode::inputCurrent(c.inputCurrentMA),           // REG00: HIZ off, ILIM pin off
+        0x06,                                                    // REG01: default VINDPM offset
+        0x80,                                                    // REG02: start ADC conversion
+        0x1A,                                                    // REG03: charge enabled, OTG off, SYS_MIN 3.5V
+        BQ25895Encode::chargeCurrent(c.chargeCurrentMA),         // REG04: ICHG, PUMPX off
+        static_cast<uint8_t>(0x10 | BQ25895Encode::terminationCurrent(c.terminationCurrentMA)), // REG05: IPRECHG 128mA
+        static_cast<uint8_t>((BQ25895Encode::chargeVoltage(c.chargeVoltageNV) << 2) | 0x02),   // REG06: BATLOWV 3.0V
+        static_cast<uint8_t>(0x85 |                              // REG07: EN_TERM, 12h timer
+                             (c.disableWatchdog ? 0x00 : (WATCHDOG_40S << WATCHDOG_SHIFT)) |
+                             (c.disableSafetyTimer ? 0x00 : 0x08))
+      },
+      static_cast<uint8_t>(0x80 | BQ25895Encode::vindpm(c.vindpmThresholdMV)) // REG0D: FORCE_VINDPM
+    };
+  }
+  
+  // Register value for a register covered by the image (0 for uncovered registers)
+  constexpr uint8_t value(uint8_t reg) const {
+    return reg < kBurstLength ? burst[reg] : (reg == REG0D_VINDPM ? vindpm : 0x00);
+  }
+};
+
+// Register image comparison: bits that must match for the charger to count as configured.
+// Self-clearing bits (REG02 CONV_START, REG03 WD_RST) are excluded.
+constexpr uint8_t BQ25895ImageCompareMask(uint8_t reg) {
+  return reg == REG02_ADC_CONTROL ? 0x7F : (reg == REG03_CHARGE_CONFIG ? 0xBF : 0xFF);
+}
+
+// Compile-time register image for a constexpr configuration source, e.g.
+//   BQ25895CompiledConfig<&BQ25895ConfigPresets::LEDDriver>::image
+// Out-of-range fields fail the build instead of being clamped at runtime.
+template <BQ25895Config (*Source)()>
+struct BQ25895CompiledConfig {
+  static_assert(BQ25895Limits::inputCurrentValid(Source().inputCurrentMA),
+                "BQ25895Config: inputCurrentMA must be 100-3250mA");
+  static_assert(BQ25895Limits::chargeCurrentValid(Source().chargeCurrentMA),
+                "BQ25895Config: chargeCurrentMA must be 0-5056mA");
+  static_assert(BQ25895Limits::chargeVoltageValid(Source().chargeVoltageNV),
+                "BQ25895Config: chargeVoltageNV must be 3840-4608mV");
+  static_assert(BQ25895Limits::terminationCurrentValid(Source().terminationCurrentMA),
+                "BQ25895Config: terminationCurrentMA must be 64-1024mA");
+  static_assert(BQ25895Limits::vindpmValid(Source().vindpmThresholdMV),
+                "BQ25895Config: vindpmThresholdMV must be 3900-15300mV");
+  
+  static constexpr BQ25895Config config = Source();
+  static constexpr BQ25895RegisterImage image = BQ25895RegisterImage::compile(Source());
+};
+
+template <BQ25895Config (*Source)()>
+constexpr BQ25895Config BQ25895CompiledConfig<Source>::config;
+template <BQ25895Config (*Source)()>
+constexpr BQ25895RegisterImage BQ25895CompiledConfig<Source>::image;
+
 // Current measurements and status
 struct BQ25895Metrics {
   uint16_t batteryVoltage = 0;    // mV
@@ -178,6 +360,7 @@ struct BQ25895Metrics {
   uint16_t inputVoltage = 0;      // mV
   int16_t chargeCurrentMA = 0;    // mA
   uint16_t tsVoltage = 0;         // mV - thermistor voltage
+  bool thermalRegulation = false; // REG0E THERM_STAT: IC is folding back current on die temperature
   unsigned long timestamp = 0;   // When measurements were taken
 };
 
@@ -197,6 +380,132 @@ struct BQ25895Status {
   unsigned long timestamp = 0;
 };
 
+// Initialization report: how the driver reached the ready state
+enum class BQ25895StartType : uint8_t {
+  NONE = 0,   // Not initialized yet
+  COLD = 1,   // Full configuration sequence was written
+  WARM = 2    // Charger still held the configuration; only differences were rewritten
+};
+
+struct BQ25895InitReport {
+  BQ25895StartType startType = BQ25895StartType::NONE;
+  uint8_t registersReprogrammed = 0; // Registers rewritten during init
+  uint16_t busTransactions = 0;      // I2C transactions used (including retries)
+  unsigned long durationUs = 0;      // Time from initialize() entry to ready
+};
+
+// Fast power-path selection; each transition writes only the register bit that differs
+enum class BQ25895PowerPath : uint8_t {
+  ADAPTER = 0,     // Input powers the system and charges as configured
+  NO_CHARGE = 1,   // Input powers the system, charging suspended (CHG_CONFIG = 0)
+  BATTERY = 2      // Input suspended (EN_HIZ): the system runs from the battery
+};
+
+struct BQ25895PowerPathReport {
+  BQ25895PowerPath path = BQ25895PowerPath::ADAPTER;
+  uint16_t busTransactions = 0;      // I2C transactions used by the last switch (0 = already there)
+  unsigned long durationUs = 0;      // Time from setPowerPath() entry to the new path written
+  unsigned long timestamp = 0;       // millis() of the last switch
+};
+
+// How far USB recovery had to escalate
+enum class BQ25895RecoveryRung : uint8_t {
+  NONE = 0,          // Detection was working
+  REDETECT = 1,      // FORCE_DPDM re-ran D+/D- detection; configuration kept
+  FULL_RESET = 2     // REG_RST and initialize()
+};
+
+struct BQ25895RecoveryReport {
+  BQ25895RecoveryRung rung = BQ25895RecoveryRung::NONE;
+  bool recovered = false;
+  uint8_t redetectAttempts = 0;
+  uint16_t busTransactions = 0;      // From the detection check to the end of recovery
+  unsigned long durationMs = 0;      // Same span; the settle delay before it is not included
+  unsigned long timestamp = 0;       // millis() when recovery finished
+};
+
+// Sticky fault history for one category
+struct BQ25895FaultRecord {
+  uint16_t count = 0;              // Polls that reported this fault
+  unsigned long firstSeen = 0;     // millis() of first report since acknowledge
+  unsigned long lastSeen = 0;      // millis() of most recent report
+};
+
+// Fault accumulator views (masks use BQ25895FaultMask bit positions)
+struct BQ25895FaultSummary {
+  uint8_t current = 0;             // Categories in the most recent REG0C read
+  uint8_t unacknowledged = 0;      // Categories seen since the last acknowledgeFaults()
+  uint8_t sinceBoot = 0;           // Categories seen since the driver was constructed
+  uint8_t lastRaw = 0;             // Most recent raw REG0C value
+  BQ25895FaultRecord records[BQ25895_FAULT_CATEGORIES];
+};
+
+// Register drift: the charger's configuration no longer matches what the driver wrote
+enum class BQ25895DriftCause : uint8_t {
+  NONE = 0,            // Configuration matches
+  FIELD_CHANGE = 1,    // Individual fields changed (e.g. IINLIM after input detection)
+  WATCHDOG_RESET = 2,  // REG0C WATCHDOG_FAULT: REG02-REG07 back at their defaults
+  REGISTER_RESET = 3   // FORCE_VINDPM cleared: REG_RST, brown-out or power-on reset
+};
+
+struct BQ25895DriftStats {
+  uint32_t checks = 0;               // Snapshots compared
+  uint32_t driftEvents = 0;          // Snapshots that diverged from the image
+  uint32_t watchdogResets = 0;       // Drift events classified as watchdog expiry
+  uint32_t registerResets = 0;       // Drift events classified as register reset
+  uint32_t registersRepaired = 0;    // Total registers rewritten
+  uint16_t lastDivergedMask = 0;     // Bit n set when REGn diverged in the last event
+  BQ25895DriftCause lastCause = BQ25895DriftCause::NONE;
+  unsigned long lastDriftTime = 0;
+};
+
+// Input Current Optimizer run (adapter capability discovery)
+enum class BQ25895IcoState : uint8_t {
+  IDLE = 0,      // Never run
+  RUNNING = 1,   // FORCE_ICO issued, waiting for ICO_OPTIMIZED
+  COMPLETE = 2,  // Limit discovered and programmed into IINLIM
+  CACHED = 3,    // Limit reused from an earlier run on the same VBusType
+  FAILED = 4     // Timed out, input changed, or I2C failure
+};
+
+struct BQ25895IcoResult {
+  BQ25895IcoState state = BQ25895IcoState::IDLE;
+  VBusType vbusType = VBusType::NONE;  // Adapter the limit belongs to
+  uint16_t limitMA = 0;                // Discovered (or cached) input current limit
+  unsigned long startTime = 0;
+  unsigned long durationMs = 0;        // Time until ICO_OPTIMIZED (0 for cached results)
+  bool fromCache = false;
+};
+
+// High-voltage adapter negotiation (HVDCP / MaxCharge / PUMPX)
+enum class BQ25895HvState : uint8_t {
+  IDLE = 0,         // 5V input, no negotiation
+  NEGOTIATING = 1,  // Stepping VBUS with PUMPX pulses
+  ACTIVE = 2,       // Running at the negotiated voltage
+  UNSUPPORTED = 3,  // Adapter did not raise VBUS; left at 5V
+  LIMITED = 4,      // voltageSafetyLimitMV leaves no room above 5V
+  FAILED = 5        // Overshoot, timeout or I2C failure; fell back to 5V
+};
+
+struct BQ25895HvConfig {
+  uint16_t targetMV = 9000;          // Requested VBUS, capped at voltageSafetyLimitMV - marginMV
+  uint16_t marginMV = 500;           // Headroom kept below the safety limit
+  uint16_t adapterPowerMW = 18000;   // IINLIM at the new voltage = power / VBUS
+  uint16_t settleMs = 300;           // Wait after each pulse before measuring VBUS
+  uint8_t maxSteps = 8;              // PUMPX pulses before settling for what was reached
+};
+
+struct BQ25895HvResult {
+  BQ25895HvState state = BQ25895HvState::IDLE;
+  uint16_t vbusMV = 0;               // Last measured VBUS
+  uint16_t ceilingMV = 0;            // Effective target after the safety cap
+  uint8_t steps = 0;                 // PUMPX pulses issued
+  uint16_t inputLimitMA = 0;         // IINLIM programmed for the new voltage
+  uint16_t vindpmMV = 0;             // VINDPM programmed for the new voltage
+  unsigned long startTime = 0;
+  unsigned long durationMs = 0;
+};
+
 // Main BQ25895 Driver Class
 class BQ25895Driver {
 private:
@@ -204,36 +513,161 @@ private:
   BQ25895Config config_;
   bool initialized_ = false;
   bool emergencyMode_ = false;
+  BQ25895PowerPathReport powerPathReport_;
   unsigned long lastUpdate_ = 0;
   String lastError_ = "";
   
   // Power transition tracking
   VBusType lastVbusType_ = VBusType::NONE;
   unsigned long lastVbusChangeTime_ = 0;
-  bool usbReconnectionInProgress_ = false;
-  unsigned long usbReconnectionStartTime_ = 0;
+  
+  // Procedure engine: factory reset, USB recovery and emergency entry/exit as timed steps
+  BQ25895ProcedureRunner procedure_;
+  bool recoveryExternalPower_ = false;  // Latest handleUSBReconnection() argument
+  BQ25895RecoveryReport recoveryReport_;
+  unsigned long recoveryStart_ = 0;
+  unsigned long recoveryRungStart_ = 0;
+  uint16_t recoveryStartTransactions_ = 0;
   
   // Voltage safety protection
   bool voltageSafe_ = true;
   bool emergencyShutdownTriggered_ = false;
   
+  // Init timing and bus accounting
+  BQ25895InitReport initReport_;
+  uint16_t busTransactions_ = 0;
+  
+  // Expected register contents (updated on every successful configuration write)
+  BQ25895RegisterImage image_ = BQ25895RegisterImage::compile(BQ25895Config{});
+  BQ25895DriftStats driftStats_;
+  unsigned long driftCheckIntervalMs_ = 0; // 0 = drift monitor disabled
+  unsigned long lastDriftCheck_ = 0;
+  bool watchdogExpired_ = false;            // WATCHDOG_FAULT latched since the last drift check
+  
+  // Fault latch accumulator (REG0C is read once per poll)
+  BQ25895FaultSummary faults_;
+  
+  // Event history with the last observed status registers
+  BQ25895EventHistory events_;
+  uint8_t lastReg0B_ = 0;
+  uint8_t lastReg09_ = 0;
+  
+  // Battery analytics, fed from getMetrics()
+  BQ25895SocEstimator soc_;
+  BQ25895ChargePredictor predictor_;
+  BQ25895HealthEstimator health_;
+  BQ25895SessionTracker sessions_;
+  BQ25895ThermalGovernor thermal_;
+  BQ25895StepProfile stepProfile_;
+  BQ25895StepChargeState stepState_;
+  BQ25895TempZones zones_;
+  
+  // ICHG/VREG in effect before a step profile or zone table took over
+  uint16_t chargeBaseCurrentMA_ = 0;
+  uint16_t chargeBaseVoltageMV_ = 0;
+  bool chargeBaseCaptured_ = false;
+  
+  BQ25895PowerBudgeter budget_;
+  BQ25895BrownoutPredictor brownout_;
+  BQ25895OscillationDetector oscillation_;
+  bool oscillationPending_ = false;     // Detection waiting for mitigation in getStatus()
+  uint8_t oscillationSavedReg05_ = 0;   // REG05/REG0D before mitigation raised ITERM/VINDPM
+  uint8_t oscillationSavedVindpm_ = 0;
+  bool oscillationRaisedTermination_ = false;
+  bool oscillationRaisedVindpm_ = false;
+  bool oscillationDetached_ = false;    // VBUS seen absent while a raise is in effect
+  unsigned long oscillationDetachedSince_ = 0;
+  BQ25895VindpmTracker vindpm_;
+  bool vindpmAttached_ = false;         // Tracker has been based on the current adapter
+  uint8_t budgetSavedInput_ = 0;        // REG00 before the budget raised IINLIM
+  bool budgetRaisedInput_ = false;
+  BQ25895PowerFlowEstimator powerFlow_;
+  
+  // REG0B/REG13 as read once per getMetrics() sample and shared by the per-sample consumers
+  uint8_t sampleReg0B_ = 0;
+  uint8_t sampleReg13_ = 0;
+  uint8_t sampleCached_ = 0;            // Bit 0: REG0B, bit 1: REG13
+  
+  // Input Current Optimizer: current run and discovered limits per VBusType
+  BQ25895IcoResult ico_;
+  uint16_t icoCache_[8] = {};
+  bool icoOnAttach_ = false;
+  VBusType icoSeenVbus_ = VBusType::NONE;
+  
+  // High-voltage negotiation: PUMPX step, settle, measure VBUS, repeat
+  enum class HvPhase : uint8_t { SETTLE, CONVERT };
+  BQ25895HvResult hv_;
+  BQ25895HvConfig hvConfig_;
+  HvPhase hvPhase_ = HvPhase::SETTLE;
+  unsigned long hvPhaseStart_ = 0;
+  uint16_t hvBaselineMV_ = 0;
+  uint16_t hvLastMV_ = 0;
+  bool hvSteppedDown_ = false;
+  uint8_t hvSavedInput_ = 0;         // REG00 and REG0D to restore at 5V
+  uint8_t hvSavedVindpm_ = 0;
+  
   // Internal helper methods
   bool writeRegisterWithRetry(uint8_t reg, uint8_t value, int maxRetries = 3);
   bool readRegisterWithRetry(uint8_t reg, uint8_t& value, int maxRetries = 3);
   bool updateRegisterBits(uint8_t reg, uint8_t mask, uint8_t value);
+  bool writeRegisterBurst(uint8_t startReg, const uint8_t* values, uint8_t count, int maxRetries = 3);
+  bool readRegisterBurst(uint8_t startReg, uint8_t* values, uint8_t count, int maxRetries = 3);
+  bool writeRegisterImage(const BQ25895RegisterImage& image);
+  void trackImageWrite(uint8_t reg, uint8_t value);
+  bool readFaults(uint8_t& value);
+  void observeRegisterRead(uint8_t reg, uint8_t value);
+  void recordEvent(BQ25895EventCode code, uint8_t detail = 0);
+  void updateAnalytics(const BQ25895Metrics& metrics);
+  void updateThermalGovernor(const BQ25895Metrics& metrics);
+  void updateStepCharging(const BQ25895Metrics& metrics);
+  void updateTemperatureZones(const BQ25895Metrics& metrics);
+  void updatePowerBudget(const BQ25895Metrics& metrics);
+  void updateBrownoutPredictor(const BQ25895Metrics& metrics);
+  void mitigateOscillation();
+  void checkOscillationDetach();
+  void restoreOscillationMitigation();
+  void updateVindpmTracking(const BQ25895Metrics& metrics);
+  void updatePowerFlow(const BQ25895Metrics& metrics);
+  bool readSampleRegister(uint8_t reg, uint8_t& value);
+  bool inputPowered(uint8_t reg0B) const;
+  bool startProcedure(BQ25895ProcedureId id, uint32_t timeoutMs);
+  bool finishProcedure();
+  BQ25895StepResult runProcedureStep();
+  BQ25895StepResult factoryResetStep(uint8_t step);
+  BQ25895StepResult usbRecoveryStep(uint8_t step);
+  BQ25895StepResult emergencyEnterStep(uint8_t step);
+  BQ25895StepResult emergencyExitStep(uint8_t step);
+  BQ25895StepResult forceRestartChargingStep(uint8_t step);
+  bool resetComplete();
+  void finishRecovery(bool recovered);
+  void restoreBudgetInputLimit();
+  bool chargePoliciesActive() const;
+  void captureChargeBase();
+  void chargeDemand(uint16_t& currentMA, uint16_t& voltageMV) const;
+  void chargeTargetCeiling(uint16_t& currentMA, uint16_t& voltageMV) const;
+  bool applyChargeTargets();
+  bool writeChargeTargets(uint16_t currentMA, uint16_t voltageMV);
+  bool issueHvPulse(uint8_t pulse);
+  void finishHvNegotiation(uint16_t vbusMV);
+  void abortHvNegotiation(BQ25895HvState state, const char* reason); // nullptr = normal release
+  bool reconcileImage(const uint8_t* snapshot, uint8_t vindpm, bool repair,
+                      uint8_t& diverged, uint16_t& divergedMask);
   void setError(const String& error);
   bool verifyDevice();
-  String formatTimestamp(unsigned long timestamp);
-  void logWithTimestamp(const String& message);
+  void logWithTimestamp(const char* message);
   
 public:
   explicit BQ25895Driver(Adafruit_I2CDevice* i2c_dev);
   
   // Initialization and configuration
   bool initialize(const BQ25895Config& config = BQ25895Config{});
+  bool initialize(const BQ25895Config& config, const BQ25895RegisterImage& image);
+  bool warmStart(const BQ25895Config& config = BQ25895Config{});
+  bool warmStart(const BQ25895Config& config, const BQ25895RegisterImage& image);
+  BQ25895InitReport getInitReport() const;
   bool isInitialized() const;
   void reset();
-  void factoryReset();
+  void factoryReset();             // Blocking; see startFactoryReset()
   
   // Status and measurements
   BQ25895Status getStatus();
@@ -248,6 +682,22 @@ public:
   bool setChargeVoltage(uint16_t voltageMV);
   bool setTerminationCurrent(uint16_t currentMA);
   
+  // Input Current Optimizer: find the adapter's maximum input current without blocking.
+  // The search runs up to ceilingMA (0 = current IINLIM); results are cached per VBusType.
+  bool startInputCurrentOptimization(uint16_t ceilingMA = 0, bool useCache = true);
+  BQ25895IcoState pollInputCurrentOptimization(); // Call from loop() (updateAll() does)
+  void setInputCurrentOptimizationOnAttach(bool enabled); // Run (or reuse the cache) on VBUS attach
+  BQ25895IcoResult getIcoResult() const;
+  uint16_t getCachedInputLimit(VBusType type) const;  // 0 = not discovered yet
+  void clearIcoCache();
+  
+  // High-voltage adapters: raise VBUS with HVDCP/MaxCharge pulses, then retune IINLIM and VINDPM.
+  // Never exceeds config voltageSafetyLimitMV; any failure returns the adapter to 5V.
+  bool startHighVoltageNegotiation(const BQ25895HvConfig& config = BQ25895HvConfig{});
+  BQ25895HvState pollHighVoltageNegotiation();        // Call from loop() (updateAll() does)
+  bool revertToDefaultVoltage();
+  BQ25895HvResult getHighVoltageResult() const;
+  
   // VBUS and power management
   VBusType getVBusType();
   String getVBusTypeName(VBusType type);
@@ -257,15 +707,104 @@ public:
   bool clearFaults();
   uint8_t getFaultRegister();
   String decodeFaults(uint8_t faultReg);
+  static uint8_t categorizeFaults(uint8_t faultReg);
+  BQ25895FaultSummary getFaultSummary() const;
+  uint8_t getCurrentFaults() const;
+  uint8_t getUnacknowledgedFaults() const;
+  void acknowledgeFaults();
+  
+  // Event history (faults, VBUS transitions, emergency modes, I2C failures)
+  const BQ25895EventHistory& getEventHistory() const;
+  void clearEventHistory();
+  
+  // State of charge (coulomb counting with OCV correction, updated by getMetrics())
+  void configureSocEstimator(const BQ25895SocConfig& config);
+  void setBatteryLoadCurrent(uint16_t currentMA); // Discharge current while on battery
+  BQ25895SocState getStateOfCharge() const;
+  BQ25895TimePrediction getTimePrediction() const; // Time-to-full/empty (needs the SoC estimator)
+  
+  // Battery health: internal resistance from current steps, capacity fade across charges
+  void configureHealthEstimator(const BQ25895HealthConfig& config);
+  void setHealthSaveHook(BQ25895HealthSaveHook hook);   // Called when the history changes
+  bool restoreHealth(const BQ25895HealthRecord& record); // Reload history saved by the hook
+  BQ25895HealthRecord getHealthRecord() const;
+  BQ25895BatteryHealth getBatteryHealth() const;
+  
+  // Charge session analytics (VBUS attach to detach/termination); adds a REG13 read per sample
+  void setSessionTracking(bool enabled);
+  BQ25895ChargeSession getChargeSession() const;     // Active session, else the last one
+  BQ25895ChargeSession getLastChargeSession() const;
+  bool isChargeSessionActive() const;
+  
+  // Step charging: ICHG/VREG stages selected by BATV (updated by getMetrics()).
+  // Each stage change is a single I2C write; the thermal governor, if enabled, is capped by the stage.
+  bool setStepChargeProfile(const BQ25895ChargeStage* stages, uint8_t count, uint16_t hysteresisMV = 100);
+  bool clearStepChargeProfile();   // Restores the ICHG/VREG that were set before the profile
+  BQ25895StepChargeState getStepChargeState() const;
+  
+  // Temperature zones (JEITA-style): software cool/warm bands on top of the hardware cold/hot
+  // window, enforced from getMetrics() with at most one register write per zone change
+  bool configureTemperatureZones(const BQ25895TempZoneConfig& config = BQ25895TempZoneConfig{});
+  bool disableTemperatureZones();
+  BQ25895TempZoneState getTemperatureZone() const;
+  static BQ25895TempZone decodeNtcZone(uint8_t faultReg); // REG0C NTC_FAULT: COLD, NORMAL or HOT
+  
+  // Brownout early warning: projects the VSYS trend from getMetrics() samples and calls the
+  // hook once per episode when the threshold is less than leadTimeMs away
+  void configureBrownoutPredictor(const BQ25895BrownoutConfig& config = BQ25895BrownoutConfig{});
+  void disableBrownoutPredictor();
+  void setBrownoutHook(BQ25895BrownoutHook hook);
+  BQ25895BrownoutState getBrownoutState() const;
+  
+  // Power budget for VSYS loads (e.g. LEDs): the app declares its load, getMetrics() works out
+  // what the adapter and battery can supply. With rebalance set, ICHG is lowered to make room
+  // for the load and IINLIM may be raised up to adapterLimitMA.
+  void configurePowerBudget(const BQ25895PowerBudgetConfig& config = BQ25895PowerBudgetConfig{});
+  bool disablePowerBudget();       // Restores ICHG and IINLIM
+  void setSystemLoad(uint32_t loadMW);
+  BQ25895PowerBudget getPowerBudget() const;
+  
+  // Power flow: input, battery and system load in mW from each getMetrics() sample. Exact
+  // while IINLIM regulates; otherwise closed with the setSystemLoad() / setBatteryLoadCurrent()
+  // declarations, or reported as upper bounds (see BQ25895PowerFlowConfidence).
+  void setPowerFlowEstimation(bool enabled, uint8_t efficiencyPercent = 90);
+  BQ25895PowerFlow getPowerFlow() const;
+  
+  // Thermal governor: steps ICHG to stay just below thermal regulation (updated by getMetrics()).
+  // While enabled it owns ICHG; disabling restores the ceiling.
+  void configureThermalGovernor(const BQ25895ThermalConfig& config = BQ25895ThermalConfig{});
+  bool disableThermalGovernor();
+  BQ25895ThermalState getThermalState() const;
   
   // Emergency modes
   bool enterEmergencyBatteryMode();
   bool exitEmergencyMode();
   bool isInEmergencyMode() const;
   
+  // Fast power path: adapter <-> battery is a single REG00 write (EN_HIZ) and charge
+  // suspend a single REG03 write (CHG_CONFIG). The rest of the configuration is left in
+  // place, so returning to the adapter needs no re-initialization.
+  bool setPowerPath(BQ25895PowerPath path);
+  BQ25895PowerPath getPowerPath() const;
+  BQ25895PowerPathReport getPowerPathReport() const;
+  
+  // Procedure engine: multi-step operations started here and advanced by tick() (also run
+  // from updateAll()), so the main loop never blocks on their waits. One procedure runs at a
+  // time; emergency entry preempts whatever is running. factoryReset(),
+  // enterEmergencyBatteryMode(), exitEmergencyMode() and forceRestartCharging() run the same
+  // steps to completion, and handleUSBReconnection() drives USB recovery one tick per call.
+  bool startFactoryReset();
+  bool startEmergencyEntry();
+  bool startEmergencyExit();
+  bool startForceRestartCharging();
+  bool tick();                     // True while a procedure is still running
+  bool isProcedureRunning() const;
+  BQ25895ProcedureState getProcedureState() const;
+  
   // Power management and transitions
   bool checkStartupScenario(bool externalPowerPresent);
-  bool handleUSBReconnection(bool externalPowerPresent);
+  bool handleUSBReconnection(bool externalPowerPresent);   // Re-detection first, full reset last
+  BQ25895RecoveryReport getRecoveryReport() const;
   bool handlePowerLoss();
   bool prepareForShutdown();
   
@@ -281,6 +820,12 @@ public:
   String getVoltageAnalysis();
   String getRegisterDiagnostics();
   
+  // Register drift monitoring (watchdog expiry, brown-out, REG_RST)
+  void setDriftCheckInterval(unsigned long intervalMs); // 0 disables periodic checks
+  bool pollDriftMonitor();                              // Call from loop(); checks when due
+  bool checkRegisterDrift(bool repair = true);          // Snapshot, compare, optionally repair
+  BQ25895DriftStats getDriftStats() const;
+  
   // Advanced control functions (moved from main.cpp)
   bool repairRegisters();
   bool forceEnableBATFET();
@@ -295,8 +840,19 @@ public:
   };
   PowerTransition detectVBusChanges();
   
-  // Simple monitoring (removed complex oscillation detection)
-  bool isChargeOscillationDetected() const { return false; } // Legacy compatibility
+  // VINDPM auto-tracking: steps the absolute VINDPM down while the charger regulates on input
+  // voltage and each step buys charge power; backs off on VBUS collapse (updated by getMetrics(),
+  // adds REG0B and REG13 reads). The ceiling is restored on detach and on disable.
+  bool configureVindpmTracking(const BQ25895VindpmConfig& config = BQ25895VindpmConfig{});
+  bool disableVindpmTracking();
+  BQ25895VindpmState getVindpmState() const;
+  
+  // Charge oscillation: CHRG_STAT cycling and VBUS flapping counted in a sliding window of
+  // fixed buckets over every REG0B read. With mitigate set, getStatus() raises ITERM / VINDPM.
+  void configureOscillationDetector(const BQ25895OscillationConfig& config = BQ25895OscillationConfig{});
+  void disableOscillationDetector();
+  BQ25895OscillationState getOscillationState() const;
+  bool isChargeOscillationDetected() const;   // Either condition in the current window
   
   // Watchdog management
   bool disableWatchdog();
@@ -0,0 +1,129 @@
+#include "BQ25895EventHistory.h"
+
+void BQ25895EventHistory::record(BQ25895EventCode code, uint8_t detail, uint8_t reg0B,
+                                 uint8_t reg0C, uint8_t reg09, uint32_t timestamp) {
+    BQ25895EventRecord& slot = records_[head_];
+    slot.timestamp = timestamp;
+    slot.code = code;
+    slot.detail = detail;
+    slot.reg0B = reg0B;
+    slot.reg0C = reg0C;
+    slot.reg09 = reg09;
+
+    head_ = (head_ + 1) % BQ25895_EVENT_HISTORY_SIZE;
+    if (count_ < BQ25895_EVENT_HISTORY_SIZE) {
+        count_++;
+    }
+    total_++;
+}
+
+void BQ25895EventHistory::clear() {
+    head_ = 0;
+    count_ = 0;
+    total_ = 0;
+}
+
+bool BQ25895EventHistory::get(uint8_t index, BQ25895EventRecord& record) const {
+    if (index >= count_) {
+        return false;
+    }
+
+    // Oldest entry sits at head_ once the ring has wrapped
+    uint8_t oldest = (count_ < BQ25895_EVENT_HISTORY_SIZE) ? 0 : head_;
+    record = records_[(oldest + index) % BQ25895_EVENT_HISTORY_SIZE];
+    return true;
+}
+
+bool BQ25895EventHistory::latest(BQ25895EventRecord& record) const {
+    return count_ > 0 && get(count_ - 1, record);
+}
+
+size_t BQ25895EventHistory::dump(uint8_t* buffer, size_t length) const {
+    if (!buffer || length < BQ25895_EVENT_DUMP_HEADER_SIZE) {
+        return 0;
+    }
+
+    // Only whole records are written when the buffer is short; newest ones are kept
+    uint8_t fit = static_cast<uint8_t>((length - BQ25895_EVENT_DUMP_HEADER_SIZE) / BQ25895_EVENT_DUMP_RECORD_SIZE);
+    uint8_t count = count_ < fit ? count_ : fit;
+
+    buffer[0] = BQ25895_EVENT_DUMP_MAGIC;
+    buffer[1] = BQ25895_EVENT_DUMP_VERSION;
+    buffer[2] = count;
+    buffer[3] = static_cast<uint8_t>(total_);
+    buffer[4] = static_cast<uint8_t>(total_ >> 8);
+    buffer[5] = static_cast<uint8_t>(total_ >> 16);
+    buffer[6] = static_cast<uint8_t>(total_ >> 24);
+
+    uint8_t* out = buffer + BQ25895_EVENT_DUMP_HEADER_SIZE;
+    for (uint8_t i = count_ - count; i < count_; i++) {
+        BQ25895EventRecord record;
+        get(i, record);
+        out[0] = static_cast<uint8_t>(record.timestamp);
+        out[1] = static_cast<uint8_t>(record.timestamp >> 8);
+        out[2] = static_cast<uint8_t>(record.timestamp >> 16);
+        out[3] = static_cast<uint8_t>(record.timestamp >> 24);
+        out[4] = static_cast<uint8_t>(record.code);
+        out[5] = record.detail;
+        out[6] = record.reg0B;
+        out[7] = record.reg0C;
+        out[8] = record.reg09;
+        out += BQ25895_EVENT_DUMP_RECORD_SIZE;
+    }
+
+    return dumpSize(count);
+}
+
+size_t BQ25895EventHistory::decode(const uint8_t* buffer, size_t length, BQ25895EventRecord* records,
+                                   size_t maxRecords, uint32_t* totalRecorded) {
+    if (!buffer || length < BQ25895_EVENT_DUMP_HEADER_SIZE ||
+        buffer[0] != BQ25895_EVENT_DUMP_MAGIC || buffer[1] != BQ25895_EVENT_DUMP_VERSION) {
+        return 0;
+    }
+
+    uint8_t count = buffer[2];
+    if (length < dumpSize(count)) {
+        return 0; // Truncated dump
+    }
+    if (totalRecorded) {
+        *totalRecorded = static_cast<uint32_t>(buffer[3]) | (static_cast<uint32_t>(buffer[4]) << 8) |
+                         (static_cast<uint32_t>(buffer[5]) << 16) | (static_cast<uint32_t>(buffer[6]) << 24);
+    }
+
+    const uint8_t* in = buffer + BQ25895_EVENT_DUMP_HEADER_SIZE;
+    size_t decoded = 0;
+    for (; decoded < count && decoded < maxRecords; decoded++) {
+        BQ25895EventRecord& record = records[decoded];
+        record.timestamp = static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+                           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+        record.code = static_cast<BQ25895EventCode>(in[4]);
+        record.detail = in[5];
+        record.reg0B = in[6];
+        record.reg0C = in[7];
+        record.reg09 = in[8];
+        in += BQ25895_EVENT_DUMP_RECORD_SIZE;
+    }
+
+    return decoded;
+}
+
+const char* BQ25895EventHistory::eventName(BQ25895EventCode code) {
+    switch (code) {
+        case BQ25895EventCode::NONE: return "None";
+        case BQ25895EventCode::INIT: return "Init";
+        case BQ25895EventCode::FAULT: return "Fault";
+        case BQ25895EventCode::VBUS_ATTACH: return "VBUS attach";
+        case BQ25895EventCode::VBUS_DETACH: return "VBUS detach";
+        case BQ25895EventCode::VBUS_CHANGE: return "VBUS change";
+        case BQ25895EventCode::EMERGENCY_ENTER: return "Emergency enter";
+        case BQ25895EventCode::EMERGENCY_EXIT: return "Emergency exit";
+        case BQ25895EventCode::SAFETY_SHUTDOWN: return "Safety shutdown";
+        case BQ25895EventCode::POWER_LOSS: return "Power loss";
+        case BQ25895EventCode::I2C_READ_FAILURE: return "I2C read failure";
+        case BQ25895EventCode::I2C_WRITE_FAILURE: return "I2C write failure";
+        case BQ25895EventCode::REGISTER_DRIFT: return "Register drift";
+        case BQ25895EventCode::BROWNOUT_WARNING: return "Brownout warning";
+        case BQ25895EventCode::POWER_PATH: return "Power path";
+        default: return "Unknown";
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef BQ25895_EVENT_HISTORY_H
+#define BQ25895_EVENT_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Number of events kept in RAM, 1-255 (oldest events are overwritten)
+#ifndef BQ25895_EVENT_HISTORY_SIZE
+#define BQ25895_EVENT_HISTORY_SIZE 32
+#endif
+
+// Binary dump format: 7-byte header followed by 9-byte records, oldest first, little-endian
+#define BQ25895_EVENT_DUMP_MAGIC 0xB5
+#define BQ25895_EVENT_DUMP_VERSION 1
+#define BQ25895_EVENT_DUMP_HEADER_SIZE 7
+#define BQ25895_EVENT_DUMP_RECORD_SIZE 9
+
+// Event codes recorded by the driver
+enum class BQ25895EventCode : uint8_t {
+  NONE = 0,
+  INIT = 1,              // detail: BQ25895StartType
+  FAULT = 2,             // detail: fault category mask
+  VBUS_ATTACH = 3,       // detail: VBusType
+  VBUS_DETACH = 4,       // detail: previous VBusType
+  VBUS_CHANGE = 5,       // detail: new VBusType
+  EMERGENCY_ENTER = 6,
+  EMERGENCY_EXIT = 7,
+  SAFETY_SHUTDOWN = 8,
+  POWER_LOSS = 9,
+  I2C_READ_FAILURE = 10, // detail: register address
+  I2C_WRITE_FAILURE = 11,// detail: register address
+  REGISTER_DRIFT = 12,   // detail: BQ25895DriftCause
+  BROWNOUT_WARNING = 13, // detail: projected seconds to the VSYS threshold (capped at 255)
+  POWER_PATH = 14        // detail: BQ25895PowerPath
+};
+
+// One event with the status registers cached at the time it was recorded
+struct BQ25895EventRecord {
+  uint32_t timestamp = 0;  // millis()
+  BQ25895EventCode code = BQ25895EventCode::NONE;
+  uint8_t detail = 0;      // Event-specific argument (see BQ25895EventCode)
+  uint8_t reg0B = 0;       // System status
+  uint8_t reg0C = 0;       // Fault register
+  uint8_t reg09 = 0;       // BATFET/ICO control
+};
+
+// Fixed-size event ring; no allocation, safe to keep enabled in production
+class BQ25895EventHistory {
+public:
+  void record(BQ25895EventCode code, uint8_t detail, uint8_t reg0B, uint8_t reg0C,
+              uint8_t reg09, uint32_t timestamp);
+  void clear();
+
+  uint8_t size() const { return count_; }
+  uint32_t totalRecorded() const { return total_; }
+  bool get(uint8_t index, BQ25895EventRecord& record) const; // 0 = oldest
+  bool latest(BQ25895EventRecord& record) const;
+
+  // Compact binary dump; returns bytes written (0 if the buffer is too small for the header)
+  size_t dump(uint8_t* buffer, size_t length) const;
+  static size_t dumpSize(uint8_t count) {
+    return BQ25895_EVENT_DUMP_HEADER_SIZE + count * BQ25895_EVENT_DUMP_RECORD_SIZE;
+  }
+
+  // Decode a dump produced by dump(); returns records decoded (0 on a malformed dump)
+  static size_t decode(const uint8_t* buffer, size_t length, BQ25895EventRecord* records,
+                       size_t maxRecords, uint32_t* totalRecorded = nullptr);
+  static const char* eventName(BQ25895EventCode code);
+
+private:
+  static_assert(BQ25895_EVENT_HISTORY_SIZE > 0 && BQ25895_EVENT_HISTORY_SIZE <= 255,
+                "BQ25895_EVENT_HISTORY_SIZE must be 1-255 (one-byte ring indices and dump count)");
+
+  BQ25895EventRecord records_[BQ25895_EVENT_HISTORY_SIZE];
+  uint8_t head_ = 0;   // Next slot to write
+  uint8_t count_ = 0;
+  uint32_t total_ = 0; // Events recorded since clear(), including overwritten ones
+};
+
+#endif // BQ25895_EVENT_HISTORY_H
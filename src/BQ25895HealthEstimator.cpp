@@ -0,0 +1,160 @@
+#include "BQ25895HealthEstimator.h"
+
+const uint8_t BQ25895HealthEstimator::kBaselineSamples;
+
+void BQ25895HealthEstimator::configure(const BQ25895HealthConfig& config) {
+    config_ = config;
+    havePrevious_ = false;
+    inSession_ = false;
+}
+
+uint16_t BQ25895HealthEstimator::checksum(const BQ25895HealthRecord& record) {
+    // Fletcher-16 over the fields in declaration order
+    const uint16_t fields[] = {record.version, record.resistanceMilliOhm, record.baselineMilliOhm,
+                               record.resistanceSamples, record.capacityMAh, record.capacitySessions};
+    uint16_t a = 0, b = 0;
+    for (uint8_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        a = (a + (fields[i] & 0xFF)) % 255;
+        b = (b + a) % 255;
+        a = (a + (fields[i] >> 8)) % 255;
+        b = (b + a) % 255;
+    }
+    return static_cast<uint16_t>((b << 8) | a);
+}
+
+BQ25895HealthRecord BQ25895HealthEstimator::record() const {
+    BQ25895HealthRecord record;
+    record.resistanceMilliOhm = static_cast<uint16_t>(resistanceX8_ / 8);
+    record.baselineMilliOhm = baselineMilliOhm_;
+    record.resistanceSamples = resistanceSamples_;
+    record.capacityMAh = capacityMAh_;
+    record.capacitySessions = capacitySessions_;
+    record.checksum = checksum(record);
+    return record;
+}
+
+bool BQ25895HealthEstimator::restore(const BQ25895HealthRecord& record) {
+    if (record.version != BQ25895_HEALTH_RECORD_VERSION || record.checksum != checksum(record)) {
+        return false;
+    }
+    resistanceX8_ = static_cast<uint32_t>(record.resistanceMilliOhm) * 8;
+    baselineMilliOhm_ = record.baselineMilliOhm;
+    resistanceSamples_ = record.resistanceSamples;
+    // A partially built baseline is restarted rather than resumed
+    baselineSum_ = 0;
+    if (resistanceSamples_ < kBaselineSamples) {
+        baselineMilliOhm_ = 0;
+        resistanceSamples_ = 0;
+        resistanceX8_ = 0;
+    }
+    capacityMAh_ = record.capacityMAh;
+    capacitySessions_ = record.capacitySessions;
+    dirty_ = false;
+    return true;
+}
+
+void BQ25895HealthEstimator::save() {
+    if (dirty_ && saveHook_) {
+        saveHook_(record());
+    }
+    dirty_ = false;
+}
+
+void BQ25895HealthEstimator::addResistance(uint16_t milliOhm) {
+    lastStepMilliOhm_ = milliOhm;
+    if (resistanceSamples_ == 0) {
+        resistanceX8_ = static_cast<uint32_t>(milliOhm) * 8;
+    } else {
+        resistanceX8_ = resistanceX8_ - resistanceX8_ / 8 + milliOhm;
+    }
+    if (resistanceSamples_ < kBaselineSamples) {
+        baselineSum_ += milliOhm;
+        if (resistanceSamples_ + 1 == kBaselineSamples) {
+            baselineMilliOhm_ = static_cast<uint16_t>(baselineSum_ / kBaselineSamples);
+        }
+    }
+    if (resistanceSamples_ < 0xFFFF) {
+        resistanceSamples_++;
+    }
+    dirty_ = true;
+}
+
+void BQ25895HealthEstimator::finishSession(bool terminated) {
+    if (terminated && sessionUsable_ &&
+        1000 - sessionStartPermille_ >= config_.minCapacitySpanPermille) {
+        uint32_t measured = sessionUAh_ / (1000 - sessionStartPermille_);
+        if (measured > 0 && measured < 0xFFFF) {
+            capacityMAh_ = capacityMAh_ ? static_cast<uint16_t>((capacityMAh_ * 3 + measured) / 4)
+                                        : static_cast<uint16_t>(measured);
+            capacitySessions_++;
+            dirty_ = true;
+        }
+    }
+    inSession_ = false;
+    save();
+}
+
+void BQ25895HealthEstimator::update(uint32_t timestamp, uint16_t batteryMV, int16_t batteryCurrentMA,
+                                    bool charging, bool terminated, uint16_t socPermille, bool socTrusted) {
+    if (batteryMV == 0) {
+        return;
+    }
+
+    // Resistance: the OCV barely moves between close samples, so dV/dI is the cell's R
+    if (havePrevious_ && timestamp - prevTime_ <= config_.maxStepIntervalMs) {
+        int32_t deltaMA = static_cast<int32_t>(batteryCurrentMA) - prevMA_;
+        int32_t deltaMV = static_cast<int32_t>(batteryMV) - prevMV_;
+        int32_t magnitude = deltaMA < 0 ? -deltaMA : deltaMA;
+        if (magnitude >= config_.minStepMA) {
+            int32_t milliOhm = deltaMV * 1000 / deltaMA;
+            if (milliOhm > 0 && milliOhm <= config_.maxResistanceMilliOhm) {
+                addResistance(static_cast<uint16_t>(milliOhm));
+            }
+        }
+    }
+
+    // Capacity: count charge from a trusted starting SoC to termination
+    if (charging && !inSession_) {
+        inSession_ = true;
+        sessionUsable_ = socTrusted;
+        sessionStartPermille_ = socPermille;
+        sessionChargeMAms_ = 0;
+        sessionUAh_ = 0;
+    } else if (inSession_ && havePrevious_) {
+        if (prevMA_ > 0) {
+            sessionChargeMAms_ += static_cast<uint32_t>(prevMA_) * (timestamp - prevTime_);
+            sessionUAh_ += sessionChargeMAms_ / 3600;
+            sessionChargeMAms_ %= 3600;
+        }
+        if (terminated || !charging) {
+            finishSession(terminated);
+        }
+    }
+
+    havePrevious_ = true;
+    prevTime_ = timestamp;
+    prevMV_ = batteryMV;
+    prevMA_ = batteryCurrentMA;
+}
+
+BQ25895BatteryHealth BQ25895HealthEstimator::health() const {
+    BQ25895BatteryHealth health;
+    health.resistanceSamples = resistanceSamples_;
+    health.lastStepMilliOhm = lastStepMilliOhm_;
+    health.resistanceValid = resistanceSamples_ > 0;
+    health.resistanceMilliOhm = static_cast<uint16_t>(resistanceX8_ / 8);
+    health.baselineMilliOhm = baselineMilliOhm_;
+    if (baselineMilliOhm_ > 0) {
+        health.resistanceGrowthPercent = static_cast<int16_t>(
+            (static_cast<int32_t>(health.resistanceMilliOhm) - baselineMilliOhm_) * 100 / baselineMilliOhm_);
+    }
+
+    health.capacityValid = capacityMAh_ > 0;
+    health.capacityMAh = capacityMAh_;
+    health.capacitySessions = capacitySessions_;
+    if (capacityMAh_ > 0 && config_.designCapacityMAh > 0) {
+        uint32_t percent = static_cast<uint32_t>(capacityMAh_) * 100 / config_.designCapacityMAh;
+        health.stateOfHealthPercent = static_cast<uint8_t>(percent > 100 ? 100 : percent);
+    }
+    return health;
+}
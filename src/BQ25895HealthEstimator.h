@@ -0,0 +1,92 @@
+#ifndef BQ25895_HEALTH_ESTIMATOR_H
+#define BQ25895_HEALTH_ESTIMATOR_H
+
+#include <stdint.h>
+
+// Persisted health history; store it anywhere (EEPROM, flash, FRAM) and hand it back after reboot
+#define BQ25895_HEALTH_RECORD_VERSION 1
+
+struct BQ25895HealthRecord {
+  uint8_t version = BQ25895_HEALTH_RECORD_VERSION;
+  uint16_t resistanceMilliOhm = 0;    // Smoothed internal resistance
+  uint16_t baselineMilliOhm = 0;      // Average of the first measurements on this cell
+  uint16_t resistanceSamples = 0;
+  uint16_t capacityMAh = 0;           // Smoothed measured capacity (0 = not measured yet)
+  uint16_t capacitySessions = 0;      // Charges that produced a capacity measurement
+  uint16_t checksum = 0;              // Over all fields above
+};
+
+typedef void (*BQ25895HealthSaveHook)(const BQ25895HealthRecord& record);
+
+struct BQ25895HealthConfig {
+  uint16_t designCapacityMAh = 0;
+  uint16_t minStepMA = 300;           // Current change that counts as a step
+  uint32_t maxStepIntervalMs = 5000;  // Samples further apart see too much OCV drift
+  uint16_t maxResistanceMilliOhm = 2000;
+  uint16_t minCapacitySpanPermille = 300; // Charge must cover at least 30% SoC to size capacity
+};
+
+struct BQ25895BatteryHealth {
+  bool resistanceValid = false;
+  uint16_t resistanceMilliOhm = 0;
+  uint16_t baselineMilliOhm = 0;
+  int16_t resistanceGrowthPercent = 0;  // vs baseline; rising resistance is the early warning
+  uint16_t lastStepMilliOhm = 0;
+  uint16_t resistanceSamples = 0;
+  bool capacityValid = false;
+  uint16_t capacityMAh = 0;
+  uint8_t stateOfHealthPercent = 0;     // Measured / design capacity, capped at 100
+  uint16_t capacitySessions = 0;
+};
+
+// Estimates internal resistance from dV/dI across current steps in the metrics stream,
+// and capacity fade from charges that start at a trusted rest SoC and run to termination.
+class BQ25895HealthEstimator {
+public:
+  void configure(const BQ25895HealthConfig& config);
+  void setSaveHook(BQ25895HealthSaveHook hook) { saveHook_ = hook; }
+  bool restore(const BQ25895HealthRecord& record);  // false if the record is corrupt or foreign
+  BQ25895HealthRecord record() const;
+  static uint16_t checksum(const BQ25895HealthRecord& record);
+
+  // socTrusted: the SoC came from a rested OCV or full-charge anchor
+  void update(uint32_t timestamp, uint16_t batteryMV, int16_t batteryCurrentMA, bool charging,
+              bool terminated, uint16_t socPermille, bool socTrusted);
+
+  BQ25895BatteryHealth health() const;
+
+  // Measurements averaged into the baseline before it is frozen
+  static const uint8_t kBaselineSamples = 8;
+
+private:
+  void addResistance(uint16_t milliOhm);
+  void finishSession(bool terminated);
+  void save();
+
+  BQ25895HealthConfig config_;
+  BQ25895HealthSaveHook saveHook_ = nullptr;
+
+  // Previous sample for step detection
+  bool havePrevious_ = false;
+  uint32_t prevTime_ = 0;
+  uint16_t prevMV_ = 0;
+  int16_t prevMA_ = 0;
+
+  uint32_t resistanceX8_ = 0;     // EMA, 1/8 weight, mOhm * 8
+  uint32_t baselineSum_ = 0;
+  uint16_t baselineMilliOhm_ = 0;
+  uint16_t resistanceSamples_ = 0;
+  uint16_t lastStepMilliOhm_ = 0;
+
+  // Charge session used for capacity measurement
+  bool inSession_ = false;
+  bool sessionUsable_ = false;
+  uint16_t sessionStartPermille_ = 0;
+  uint32_t sessionChargeMAms_ = 0; // Sub-uAh remainder (mA*ms, one uAh = 3600)
+  uint32_t sessionUAh_ = 0;
+  uint16_t capacityMAh_ = 0;
+  uint16_t capacitySessions_ = 0;
+  bool dirty_ = false;
+};
+
+#endif // BQ25895_HEALTH_ESTIMATOR_H
@@ -0,0 +1,264 @@
+#include "BQ25895Log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+#if defined(BQ25895_LOG_BUFFERED)
+#define BQ25895_LOG_SINK &BQ25895Log::bufferedSink
+#define BQ25895_LOG_FRAME_SINK &BQ25895Log::bufferedFrameSink
+#else
+#define BQ25895_LOG_SINK &BQ25895Log::defaultSink
+#define BQ25895_LOG_FRAME_SINK &BQ25895Log::defaultFrameSink
+#endif
+
+// Orders ring data before the index that publishes it
+#if defined(__GNUC__)
+#define BQ25895_LOG_BARRIER() __sync_synchronize()
+#else
+#define BQ25895_LOG_BARRIER() do {} while (0)
+#endif
+
+#if defined(ARDUINO)
+#define BQ25895_LOG_LINE_END "\r\n"
+#else
+#define BQ25895_LOG_LINE_END "\n"
+#endif
+
+uint8_t BQ25895Log::level_ = BQ25895_LOG_LEVEL;
+uint8_t BQ25895Log::moduleMask_ = 0xFF;
+BQ25895LogSink BQ25895Log::sink_ = BQ25895_LOG_SINK;
+BQ25895LogFrameSink BQ25895Log::frameSink_ = BQ25895_LOG_FRAME_SINK;
+BQ25895LogWriter BQ25895Log::writer_ = &BQ25895Log::defaultWriter;
+BQ25895LogBuffer BQ25895Log::buffer_;
+
+void BQ25895Log::setLevel(uint8_t level) {
+    level_ = level;
+}
+
+void BQ25895Log::setModuleMask(uint8_t mask) {
+    moduleMask_ = mask;
+}
+
+void BQ25895Log::setSink(BQ25895LogSink sink) {
+    sink_ = sink ? sink : BQ25895_LOG_SINK;
+}
+
+bool BQ25895Log::enabled(uint8_t level, uint8_t module) {
+    return level <= level_ && (moduleMask_ & (1u << module)) != 0;
+}
+
+void BQ25895Log::write(uint8_t level, uint8_t module, const char* format, ...) {
+    char line[BQ25895_LOG_LINE_LENGTH];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    sink_(level, module, line);
+}
+
+void BQ25895Log::defaultSink(uint8_t level, uint8_t module, const char* message) {
+#if defined(ARDUINO)
+    Serial.println(message);
+#else
+    printf("%s\n", message);
+#endif
+}
+
+void BQ25895Log::setFrameSink(BQ25895LogFrameSink sink) {
+    frameSink_ = sink ? sink : BQ25895_LOG_FRAME_SINK;
+}
+
+void BQ25895Log::writeFrame(const BQ25895LogFrame& frame) {
+    frameSink_(frame.data(), frame.length());
+}
+
+void BQ25895Log::defaultFrameSink(const uint8_t* frame, size_t length) {
+#if defined(ARDUINO)
+    Serial.write(frame, length);
+#else
+    fwrite(frame, 1, length, stdout);
+#endif
+}
+
+BQ25895LogFrame::BQ25895LogFrame(uint8_t level, uint8_t module, uint32_t token)
+    : length_(BQ25895_LOG_FRAME_HEADER_SIZE), truncated_(false) {
+    buffer_[0] = BQ25895_LOG_FRAME_SYNC;
+    buffer_[1] = BQ25895_LOG_FRAME_HEADER_SIZE - 2;
+    buffer_[2] = static_cast<uint8_t>((level << 4) | (module & 0x0F));
+    buffer_[3] = static_cast<uint8_t>(token);
+    buffer_[4] = static_cast<uint8_t>(token >> 8);
+    buffer_[5] = static_cast<uint8_t>(token >> 16);
+    buffer_[6] = static_cast<uint8_t>(token >> 24);
+}
+
+bool BQ25895LogFrame::reserve(size_t bytes) {
+    // Once an argument is dropped the rest are too, so the host never misaligns
+    if (truncated_ || length_ + bytes > sizeof(buffer_)) {
+        truncated_ = true;
+        return false;
+    }
+    return true;
+}
+
+void BQ25895LogFrame::addSigned(long long value) {
+    // Zigzag keeps small negative numbers short
+    unsigned long long encoded = (static_cast<unsigned long long>(value) << 1) ^
+                                 static_cast<unsigned long long>(value >> 63);
+    uint8_t bytes[10];
+    size_t count = 0;
+    do {
+        uint8_t byte = encoded & 0x7F;
+        encoded >>= 7;
+        bytes[count++] = encoded ? (byte | 0x80) : byte;
+    } while (encoded);
+
+    if (reserve(count)) {
+        memcpy(buffer_ + length_, bytes, count);
+        length_ += count;
+        buffer_[1] = static_cast<uint8_t>(length_ - 2);
+    }
+}
+
+void BQ25895LogFrame::add(double value) {
+    float narrowed = static_cast<float>(value);
+    uint32_t bits;
+    memcpy(&bits, &narrowed, sizeof(bits));
+    if (reserve(4)) {
+        buffer_[length_++] = static_cast<uint8_t>(bits);
+        buffer_[length_++] = static_cast<uint8_t>(bits >> 8);
+        buffer_[length_++] = static_cast<uint8_t>(bits >> 16);
+        buffer_[length_++] = static_cast<uint8_t>(bits >> 24);
+        buffer_[1] = static_cast<uint8_t>(length_ - 2);
+    }
+}
+
+void BQ25895LogFrame::add(const char* value) {
+    size_t count = value ? strlen(value) : 0;
+    if (count > 0xFF) {
+        count = 0xFF;
+    }
+    if (reserve(count + 1)) {
+        buffer_[length_++] = static_cast<uint8_t>(count);
+        memcpy(buffer_ + length_, value, count);
+        length_ += count;
+        buffer_[1] = static_cast<uint8_t>(length_ - 2);
+    }
+}
+
+void BQ25895Log::bufferedSink(uint8_t level, uint8_t module, const char* message) {
+    buffer_.push(reinterpret_cast<const uint8_t*>(message), strlen(message), BQ25895_LOG_LINE_END);
+}
+
+void BQ25895Log::bufferedFrameSink(const uint8_t* frame, size_t length) {
+    buffer_.push(frame, length);
+}
+
+size_t BQ25895Log::drain(size_t maxBytes) {
+    return buffer_.drain(writer_, maxBytes);
+}
+
+void BQ25895Log::setDrainWriter(BQ25895LogWriter writer) {
+    writer_ = writer ? writer : &BQ25895Log::defaultWriter;
+}
+
+size_t BQ25895Log::defaultWriter(const uint8_t* data, size_t length) {
+#if defined(ARDUINO)
+    // Only hand the UART what it can take without blocking
+    int room = Serial.availableForWrite();
+    if (room <= 0) {
+        return 0;
+    }
+    return Serial.write(data, length < static_cast<size_t>(room) ? length : static_cast<size_t>(room));
+#else
+    return fwrite(data, 1, length, stdout);
+#endif
+}
+
+BQ25895LogBufferStats BQ25895Log::getBufferStats() {
+    return buffer_.stats();
+}
+
+void BQ25895Log::clearBuffer() {
+    buffer_.clear();
+}
+
+bool BQ25895LogBuffer::push(const uint8_t* data, size_t length, const char* suffix) {
+    size_t suffixLength = suffix ? strlen(suffix) : 0;
+    size_t total = length + suffixLength;
+    uint16_t head = head_;
+    uint16_t used = static_cast<uint16_t>(head - tail_);
+
+    if (total > static_cast<size_t>(BQ25895_LOG_BUFFER_SIZE - used)) {
+        droppedMessages_++;
+        droppedBytes_ += total;
+        return false;
+    }
+
+    for (size_t i = 0; i < total; i++) {
+        uint8_t byte = i < length ? data[i] : static_cast<uint8_t>(suffix[i - length]);
+        data_[static_cast<uint16_t>(head + i) & (BQ25895_LOG_BUFFER_SIZE - 1)] = byte;
+    }
+    BQ25895_LOG_BARRIER();
+    head_ = static_cast<uint16_t>(head + total);
+
+    used = static_cast<uint16_t>(used + total);
+    if (used > highWater_) {
+        highWater_ = used;
+    }
+    return true;
+}
+
+size_t BQ25895LogBuffer::drain(BQ25895LogWriter writer, size_t maxBytes) {
+    size_t drained = 0;
+    while (drained < maxBytes) {
+        uint16_t tail = tail_;
+        uint16_t available = static_cast<uint16_t>(head_ - tail);
+        if (available == 0) {
+            break;
+        }
+        BQ25895_LOG_BARRIER();
+
+        // Contiguous span up to the end of the ring
+        uint16_t offset = tail & (BQ25895_LOG_BUFFER_SIZE - 1);
+        size_t span = BQ25895_LOG_BUFFER_SIZE - offset;
+        if (span > available) {
+            span = available;
+        }
+        if (span > maxBytes - drained) {
+            span = maxBytes - drained;
+        }
+
+        size_t written = writer(data_ + offset, span);
+        if (written > span) {
+            written = span;
+        }
+        BQ25895_LOG_BARRIER();
+        tail_ = static_cast<uint16_t>(tail + written);
+        drained += written;
+        if (written < span) {
+            break; // Writer is full; resume on the next idle call
+        }
+    }
+    return drained;
+}
+
+void BQ25895LogBuffer::clear() {
+    tail_ = head_;
+    droppedMessages_ = 0;
+    droppedBytes_ = 0;
+    highWater_ = 0;
+}
+
+BQ25895LogBufferStats BQ25895LogBuffer::stats() const {
+    BQ25895LogBufferStats stats;
+    stats.droppedMessages = droppedMessages_;
+    stats.droppedBytes = droppedBytes_;
+    stats.pending = static_cast<uint16_t>(head_ - tail_);
+    stats.highWater = highWater_;
+    return stats;
+}
@@ -0,0 +1,219 @@
+#ifndef BQ25895_LOG_H
+#define BQ25895_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Log levels. Messages above BQ25895_LOG_LEVEL compile to a dead branch: the arguments are
+// still type-checked (so locals that only feed a message stay warning-free) but never
+// evaluated, and the optimizer drops the call together with its format string.
+#define BQ25895_LOG_LEVEL_NONE 0
+#define BQ25895_LOG_LEVEL_ERROR 1
+#define BQ25895_LOG_LEVEL_WARN 2
+#define BQ25895_LOG_LEVEL_INFO 3
+#define BQ25895_LOG_LEVEL_DEBUG 4   // Register-level detail (bit updates, encodings)
+#define BQ25895_LOG_LEVEL_TRACE 5   // Every I2C retry
+
+#ifndef BQ25895_LOG_LEVEL
+#define BQ25895_LOG_LEVEL BQ25895_LOG_LEVEL_INFO
+#endif
+
+// Log modules (bit positions in module masks)
+#define BQ25895_LOG_CORE 0     // Configuration and charging control
+#define BQ25895_LOG_I2C 1      // Bus transactions and retries
+#define BQ25895_LOG_INIT 2     // Initialization and reset
+#define BQ25895_LOG_POWER 3    // VBUS transitions, emergency and ship modes
+#define BQ25895_LOG_FAULT 4    // Fault decoding and drift
+#define BQ25895_LOG_SAFETY 5   // Voltage safety and emergency shutdown
+#define BQ25895_LOG_DIAG 6     // Diagnostic dumps requested by the application
+
+// Modules compiled in (constant-folded away when excluded)
+#ifndef BQ25895_LOG_MODULES
+#define BQ25895_LOG_MODULES 0xFF
+#endif
+
+// Sink receives one complete message (no trailing newline)
+typedef void (*BQ25895LogSink)(uint8_t level, uint8_t module, const char* message);
+
+#ifndef BQ25895_LOG_LINE_LENGTH
+#define BQ25895_LOG_LINE_LENGTH 128
+#endif
+
+// Tokenized frames: sync, payload length, level<<4|module, token (u32 LE), arguments.
+// Integers are zigzag varints, floating point is float32 LE, strings are length-prefixed.
+#define BQ25895_LOG_FRAME_SYNC 0xB7
+#define BQ25895_LOG_FRAME_HEADER_SIZE 7
+
+// Sink receives one complete binary frame
+typedef void (*BQ25895LogFrameSink)(const uint8_t* frame, size_t length);
+
+// 32-bit FNV-1a of a format string; scripts/detokenize.py computes the same hash
+constexpr uint32_t BQ25895LogToken(const char* format, uint32_t hash = 2166136261u) {
+  return *format ? BQ25895LogToken(format + 1, (hash ^ static_cast<uint8_t>(*format)) * 16777619u) : hash;
+}
+
+// Builds one tokenized frame; arguments that do not fit are dropped and flagged truncated
+class BQ25895LogFrame {
+public:
+  BQ25895LogFrame(uint8_t level, uint8_t module, uint32_t token);
+
+  void add(int value) { addSigned(value); }
+  void add(long value) { addSigned(value); }
+  void add(long long value) { addSigned(value); }
+  void add(unsigned int value) { addSigned(static_cast<long long>(value)); }
+  void add(unsigned long value) { addSigned(static_cast<long long>(value)); }
+  void add(unsigned long long value) { addSigned(static_cast<long long>(value)); }
+  void add(double value);
+  void add(const char* value);
+
+  const uint8_t* data() const { return buffer_; }
+  size_t length() const { return length_; }
+  bool truncated() const { return truncated_; }
+
+private:
+  void addSigned(long long value);
+  bool reserve(size_t bytes);
+
+  uint8_t buffer_[BQ25895_LOG_LINE_LENGTH];
+  size_t length_;
+  bool truncated_;
+};
+
+// Buffered output: sinks copy into a ring that drain() empties during idle time,
+// so a slow UART never stalls the caller. Build with -DBQ25895_LOG_BUFFERED to make
+// the buffered sinks the defaults.
+#ifndef BQ25895_LOG_BUFFER_SIZE
+#define BQ25895_LOG_BUFFER_SIZE 1024  // Bytes, power of two
+#endif
+
+// Drain output; returns bytes accepted and must not block (0 = try again later)
+typedef size_t (*BQ25895LogWriter)(const uint8_t* data, size_t length);
+
+struct BQ25895LogBufferStats {
+  uint32_t droppedMessages = 0;  // Messages rejected because the ring was full
+  uint32_t droppedBytes = 0;
+  uint16_t pending = 0;          // Bytes waiting to be drained
+  uint16_t highWater = 0;        // Most bytes ever pending
+};
+
+// Single-producer/single-consumer byte ring; messages are stored whole or dropped whole
+class BQ25895LogBuffer {
+public:
+  bool push(const uint8_t* data, size_t length, const char* suffix = nullptr);
+  size_t drain(BQ25895LogWriter writer, size_t maxBytes);
+  void clear();
+  BQ25895LogBufferStats stats() const;
+
+private:
+  static_assert((BQ25895_LOG_BUFFER_SIZE & (BQ25895_LOG_BUFFER_SIZE - 1)) == 0 &&
+                BQ25895_LOG_BUFFER_SIZE <= 32768, "BQ25895_LOG_BUFFER_SIZE must be a power of two <= 32768");
+
+  uint8_t data_[BQ25895_LOG_BUFFER_SIZE];
+  volatile uint16_t head_ = 0;  // Free-running; written only by push()
+  volatile uint16_t tail_ = 0;  // Free-running; written only by drain()
+  uint32_t droppedMessages_ = 0;
+  uint32_t droppedBytes_ = 0;
+  uint16_t highWater_ = 0;
+};
+
+class BQ25895Log {
+public:
+  // Runtime filters on top of the compile-time ones
+  static void setLevel(uint8_t level);
+  static void setModuleMask(uint8_t mask);
+  static void setSink(BQ25895LogSink sink);  // nullptr restores the default sink
+  static bool enabled(uint8_t level, uint8_t module);
+
+  static void write(uint8_t level, uint8_t module, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+  static void defaultSink(uint8_t level, uint8_t module, const char* message);
+
+  // Tokenized output: the format string is replaced by its hash, arguments stay binary
+  static void setFrameSink(BQ25895LogFrameSink sink);  // nullptr restores the default sink
+  static void writeFrame(const BQ25895LogFrame& frame);
+  static void defaultFrameSink(const uint8_t* frame, size_t length);
+
+  // Buffered sinks and the idle-time drain (call from loop(); updateAll() also drains)
+  static void bufferedSink(uint8_t level, uint8_t module, const char* message);
+  static void bufferedFrameSink(const uint8_t* frame, size_t length);
+  static size_t drain(size_t maxBytes = BQ25895_LOG_BUFFER_SIZE);
+  static void setDrainWriter(BQ25895LogWriter writer);  // nullptr restores the default writer
+  static size_t defaultWriter(const uint8_t* data, size_t length);
+  static BQ25895LogBufferStats getBufferStats();
+  static void clearBuffer();
+
+  template <typename... Args>
+  static void writeTokenized(uint8_t level, uint8_t module, uint32_t token, Args... args) {
+    BQ25895LogFrame frame(level, module, token);
+    int expand[] = {0, (frame.add(args), 0)...};
+    (void)expand;
+    writeFrame(frame);
+  }
+
+private:
+  static uint8_t level_;
+  static uint8_t moduleMask_;
+  static BQ25895LogSink sink_;
+  static BQ25895LogFrameSink frameSink_;
+  static BQ25895LogWriter writer_;
+  static BQ25895LogBuffer buffer_;
+};
+
+// Build with -DBQ25895_LOG_TOKENIZED to keep format strings out of flash entirely;
+// the token is forced to a compile-time constant so the literal is never referenced.
+#if defined(BQ25895_LOG_TOKENIZED)
+#define BQ25895_LOG_EMIT(level, module, format, ...) do { \
+    constexpr uint32_t bq25895LogToken = BQ25895LogToken(format); \
+    BQ25895Log::writeTokenized(level, module, bq25895LogToken, ##__VA_ARGS__); \
+  } while (0)
+#else
+#define BQ25895_LOG_EMIT(level, module, ...) BQ25895Log::write(level, module, __VA_ARGS__)
+#endif
+
+#define BQ25895_LOG_AT(level, module, ...) do { \
+    if ((BQ25895_LOG_MODULES & (1u << (module))) && BQ25895Log::enabled(level, module)) { \
+      BQ25895_LOG_EMIT(level, module, __VA_ARGS__); \
+    } \
+  } while (0)
+
+#define BQ25895_LOG_OFF(level, module, ...) do { \
+    if (0) { \
+      BQ25895_LOG_EMIT(level, module, __VA_ARGS__); \
+    } \
+  } while (0)
+
+#if BQ25895_LOG_LEVEL >= BQ25895_LOG_LEVEL_ERROR
+#define BQ25895_LOGE(module, ...) BQ25895_LOG_AT(BQ25895_LOG_LEVEL_ERROR, module, __VA_ARGS__)
+#else
+#define BQ25895_LOGE(module, ...) BQ25895_LOG_OFF(BQ25895_LOG_LEVEL_ERROR, module, __VA_ARGS__)
+#endif
+
+#if BQ25895_LOG_LEVEL >= BQ25895_LOG_LEVEL_WARN
+#define BQ25895_LOGW(module, ...) BQ25895_LOG_AT(BQ25895_LOG_LEVEL_WARN, module, __VA_ARGS__)
+#else
+#define BQ25895_LOGW(module, ...) BQ25895_LOG_OFF(BQ25895_LOG_LEVEL_WARN, module, __VA_ARGS__)
+#endif
+
+#if BQ25895_LOG_LEVEL >= BQ25895_LOG_LEVEL_INFO
+#define BQ25895_LOGI(module, ...) BQ25895_LOG_AT(BQ25895_LOG_LEVEL_INFO, module, __VA_ARGS__)
+#else
+#define BQ25895_LOGI(module, ...) BQ25895_LOG_OFF(BQ25895_LOG_LEVEL_INFO, module, __VA_ARGS__)
+#endif
+
+#if BQ25895_LOG_LEVEL >= BQ25895_LOG_LEVEL_DEBUG
+#define BQ25895_LOGD(module, ...) BQ25895_LOG_AT(BQ25895_LOG_LEVEL_DEBUG, module, __VA_ARGS__)
+#else
+#define BQ25895_LOGD(module, ...) BQ25895_LOG_OFF(BQ25895_LOG_LEVEL_DEBUG, module, __VA_ARGS__)
+#endif
+
+#if BQ25895_LOG_LEVEL >= BQ25895_LOG_LEVEL_TRACE
+#define BQ25895_LOGT(module, ...) BQ25895_LOG_AT(BQ25895_LOG_LEVEL_TRACE, module, __VA_ARGS__)
+#else
+#define BQ25895_LOGT(module, ...) BQ25895_LOG_OFF(BQ25895_LOG_LEVEL_TRACE, module, __VA_ARGS__)
+#endif
+
+#endif // BQ25895_LOG_H
@@ -0,0 +1,114 @@
+#include "BQ25895OscillationDetector.h"
+
+// REG0B fields
+#define OSC_VBUS_MASK 0xE0
+#define OSC_CHRG_MASK 0x18
+
+void BQ25895OscillationDetector::configure(const BQ25895OscillationConfig& config) {
+    config_ = config;
+    if (config_.windowMs < BQ25895_OSCILLATION_BUCKETS) {
+        config_.windowMs = BQ25895_OSCILLATION_BUCKETS;
+    }
+    bucketMs_ = config_.windowMs / BQ25895_OSCILLATION_BUCKETS;
+    enabled_ = true;
+    started_ = false;
+    chargeOscillating_ = false;
+    vbusOscillating_ = false;
+    detections_ = 0;
+    mitigations_ = 0;
+    lastDetection_ = 0;
+}
+
+void BQ25895OscillationDetector::restartWindow(uint32_t timestamp) {
+    for (uint8_t i = 0; i < BQ25895_OSCILLATION_BUCKETS; i++) {
+        charge_[i] = 0;
+        vbus_[i] = 0;
+    }
+    chargeSum_ = 0;
+    vbusSum_ = 0;
+    chargeOscillating_ = false;
+    vbusOscillating_ = false;
+    head_ = 0;
+    bucketStart_ = timestamp;
+    started_ = true;
+}
+
+void BQ25895OscillationDetector::advance(uint32_t timestamp) {
+    uint32_t elapsed = (timestamp - bucketStart_) / bucketMs_;
+    if (elapsed >= BQ25895_OSCILLATION_BUCKETS) {
+        restartWindow(timestamp);
+        return;
+    }
+    // Retire the oldest buckets as the window slides
+    for (uint32_t i = 0; i < elapsed; i++) {
+        head_ = (head_ + 1) % BQ25895_OSCILLATION_BUCKETS;
+        chargeSum_ -= charge_[head_];
+        vbusSum_ -= vbus_[head_];
+        charge_[head_] = 0;
+        vbus_[head_] = 0;
+    }
+    bucketStart_ += elapsed * bucketMs_;
+}
+
+bool BQ25895OscillationDetector::observe(uint32_t timestamp, uint8_t previousReg0B, uint8_t reg0B) {
+    if (!enabled_) {
+        return false;
+    }
+    if (!started_) {
+        restartWindow(timestamp);   // First read only primes the previous state
+        return false;
+    }
+    advance(timestamp);
+
+    bool vbusChanged = (previousReg0B & OSC_VBUS_MASK) != (reg0B & OSC_VBUS_MASK);
+    if (vbusChanged) {
+        if (vbus_[head_] < 0xFF) {
+            vbus_[head_]++;
+            vbusSum_++;
+        }
+    } else if ((reg0B & OSC_VBUS_MASK) != 0 && (previousReg0B & OSC_CHRG_MASK) != (reg0B & OSC_CHRG_MASK)) {
+        if (charge_[head_] < 0xFF) {
+            charge_[head_]++;
+            chargeSum_++;
+        }
+    }
+
+    // A zero threshold turns that check off
+    bool charge = config_.chargeThreshold != 0 && chargeSum_ >= config_.chargeThreshold;
+    bool vbus = config_.vbusThreshold != 0 && vbusSum_ >= config_.vbusThreshold;
+    bool chargeRising = charge && !chargeOscillating_;
+    bool vbusRising = vbus && !vbusOscillating_;
+    chargeOscillating_ = charge;
+    vbusOscillating_ = vbus;
+    if (!chargeRising && !vbusRising) {
+        return false;
+    }
+    if (detections_ < 0xFFFF) {
+        detections_++;
+    }
+    lastDetection_ = timestamp;
+    return true;
+}
+
+uint16_t BQ25895OscillationDetector::perHour(uint16_t transitions) const {
+    uint64_t rate = static_cast<uint64_t>(transitions) * 3600000UL / config_.windowMs;
+    return static_cast<uint16_t>(rate < 0xFFFF ? rate : 0xFFFF);
+}
+
+BQ25895OscillationState BQ25895OscillationDetector::state() const {
+    BQ25895OscillationState state;
+    state.enabled = enabled_;
+    if (!enabled_) {
+        return state;
+    }
+    state.chargeOscillating = chargeOscillating_;
+    state.vbusOscillating = vbusOscillating_;
+    state.chargeTransitions = chargeSum_;
+    state.vbusTransitions = vbusSum_;
+    state.chargePerHour = perHour(chargeSum_);
+    state.vbusPerHour = perHour(vbusSum_);
+    state.detections = detections_;
+    state.mitigations = mitigations_;
+    state.lastDetection = lastDetection_;
+    return state;
+}
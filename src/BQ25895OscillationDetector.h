@@ -0,0 +1,76 @@
+#ifndef BQ25895_OSCILLATION_DETECTOR_H
+#define BQ25895_OSCILLATION_DETECTOR_H
+
+#include <stdint.h>
+
+// Sliding window resolution: the window is split into this many fixed buckets
+#define BQ25895_OSCILLATION_BUCKETS 8
+
+struct BQ25895OscillationConfig {
+  uint32_t windowMs = 120000;          // Sliding window the transitions are counted over
+  uint8_t chargeThreshold = 6;         // CHRG_STAT changes per window that count as cycling (0 = off)
+  uint8_t vbusThreshold = 6;           // VBUS_STAT changes per window that count as flapping (0 = off)
+  bool mitigate = false;               // Retune ITERM / VINDPM when oscillation is detected
+  uint16_t terminationStepMA = 64;     // Charge cycling: raise ITERM by this much per detection
+  uint16_t maxTerminationMA = 512;
+  uint16_t vindpmStepMV = 100;         // VBUS flapping: raise VINDPM by this much per detection
+  uint16_t maxVindpmMV = 4800;
+  uint32_t detachRestoreMs = 10000;    // VBUS absent this long (not a flap) restores ITERM / VINDPM
+};
+
+struct BQ25895OscillationState {
+  bool enabled = false;
+  bool chargeOscillating = false;      // Charge state cycling (e.g. fast charge <-> termination)
+  bool vbusOscillating = false;        // Input flapping on a marginal adapter
+  uint16_t chargeTransitions = 0;      // Within the current window
+  uint16_t vbusTransitions = 0;
+  uint16_t chargePerHour = 0;          // Window counts scaled to an hourly rate
+  uint16_t vbusPerHour = 0;
+  uint16_t detections = 0;             // Rising edges of either condition
+  uint16_t mitigations = 0;            // Register changes made in response
+  uint32_t lastDetection = 0;
+};
+
+// Counts REG0B transitions in fixed-size bucketed windows: memory is two arrays of
+// BQ25895_OSCILLATION_BUCKETS counters and each observation does at most that many
+// bucket clears, so it can stay enabled in production.
+class BQ25895OscillationDetector {
+public:
+  void configure(const BQ25895OscillationConfig& config);
+  void disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+  const BQ25895OscillationConfig& config() const { return config_; }
+
+  // Feed every REG0B read. Charge changes only count while the input is stable and present.
+  // Returns true on a new detection (either condition rising).
+  bool observe(uint32_t timestamp, uint8_t previousReg0B, uint8_t reg0B);
+
+  // After a mitigation the window restarts, so each window mitigates at most once and a
+  // condition that persists escalates one step per window
+  void restartWindow(uint32_t timestamp);
+  void noteMitigation() { if (mitigations_ < 0xFFFF) mitigations_++; }
+
+  BQ25895OscillationState state() const;
+
+private:
+  void advance(uint32_t timestamp);
+  uint16_t perHour(uint16_t transitions) const;
+
+  BQ25895OscillationConfig config_;
+  bool enabled_ = false;
+  bool started_ = false;
+  uint32_t bucketMs_ = 0;
+  uint32_t bucketStart_ = 0;           // Start of the head bucket
+  uint8_t head_ = 0;
+  uint8_t charge_[BQ25895_OSCILLATION_BUCKETS];
+  uint8_t vbus_[BQ25895_OSCILLATION_BUCKETS];
+  uint16_t chargeSum_ = 0;
+  uint16_t vbusSum_ = 0;
+  bool chargeOscillating_ = false;
+  bool vbusOscillating_ = false;
+  uint16_t detections_ = 0;
+  uint16_t mitigations_ = 0;
+  uint32_t lastDetection_ = 0;
+};
+
+#endif // BQ25895_OSCILLATION_DETECTOR_H
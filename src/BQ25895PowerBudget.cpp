@@ -0,0 +1,86 @@
+#include "BQ25895PowerBudget.h"
+
+// ICHG resolution; the limit rises again only with this much room to spare
+#define BUDGET_CHARGE_STEP_MA 64
+#define BUDGET_RAISE_MARGIN_MA (2 * BUDGET_CHARGE_STEP_MA)
+
+void BQ25895PowerBudgeter::configure(const BQ25895PowerBudgetConfig& config) {
+    config_ = config;
+    if (config_.efficiencyPercent == 0 || config_.efficiencyPercent > 100) {
+        config_.efficiencyPercent = 100;
+    }
+    enabled_ = true;
+    chargeLimitMA_ = 0;
+    inputRequestMA_ = 0;
+    budget_ = BQ25895PowerBudget();
+}
+
+bool BQ25895PowerBudgeter::update(const BQ25895PowerSample& sample) {
+    if (!enabled_ || sample.batteryMV == 0) {
+        return false;
+    }
+
+    BQ25895PowerBudget budget;
+    budget.valid = true;
+    budget.externalPower = sample.externalPower;
+    budget.inputLimitMA = sample.inputLimitMA;
+    budget.loadMW = loadMW_;
+    budget.batteryMW = static_cast<uint32_t>(sample.batteryMV) * config_.batteryDischargeMA / 1000;
+    budget.vsysSagging = sample.systemMV > 0 && sample.systemMV < config_.vsysMinMV;
+
+    uint32_t budgetBase;
+    if (sample.externalPower) {
+        budget.inputMW = static_cast<uint32_t>(sample.inputMV) * sample.inputLimitMA / 1000 *
+                         config_.efficiencyPercent / 100;
+        budget.chargeMW = static_cast<uint32_t>(sample.batteryMV) * sample.chargeDemandMA / 1000;
+        budget.loadBudgetMW = budget.inputMW > budget.chargeMW ? budget.inputMW - budget.chargeMW : 0;
+        budget.availableMW = budget.inputMW + budget.batteryMW;
+        budgetBase = budget.loadBudgetMW;
+
+        // Charge current that fits in what the load leaves of the input, in ICHG steps
+        uint32_t roomMW = budget.inputMW > loadMW_ ? budget.inputMW - loadMW_ : 0;
+        uint32_t limit = roomMW * 1000 / sample.batteryMV;
+        limit -= limit % BUDGET_CHARGE_STEP_MA;
+        if (limit < config_.minChargeMA) {
+            limit = config_.minChargeMA;
+        }
+        budget.chargeLimitMA = static_cast<uint16_t>(limit < sample.chargeDemandMA ? limit : sample.chargeDemandMA);
+    } else {
+        budget.availableMW = budget.batteryMW;
+        budgetBase = budget.batteryMW;
+    }
+    budget.headroomMW = static_cast<int32_t>(budgetBase) - static_cast<int32_t>(loadMW_);
+    if (budget.headroomMW > 0 && budgetBase > 0) {
+        budget.headroomPercent = static_cast<uint8_t>(static_cast<uint32_t>(budget.headroomMW) * 100 / budgetBase);
+    }
+    budget_ = budget;
+
+    inputRequestMA_ = 0;
+    if (!config_.rebalance || !sample.externalPower || sample.inputMV == 0) {
+        return false;
+    }
+
+    // IINLIM for load plus charging, rounded up to the 50mA register step
+    if (config_.adapterLimitMA > sample.inputLimitMA) {
+        uint32_t neededMW = loadMW_ + budget.chargeMW;
+        uint32_t neededMA = (neededMW * 1000 / sample.inputMV) * 100 / config_.efficiencyPercent;
+        neededMA = (neededMA + 49) / 50 * 50;
+        if (neededMA > sample.inputLimitMA) {
+            inputRequestMA_ = static_cast<uint16_t>(neededMA < config_.adapterLimitMA ? neededMA
+                                                                                     : config_.adapterLimitMA);
+        }
+    }
+
+    uint16_t next = chargeLimitMA_;
+    if (budget.chargeLimitMA >= sample.chargeDemandMA) {
+        next = 0;
+    } else if (chargeLimitMA_ == 0 || budget.chargeLimitMA < chargeLimitMA_ ||
+               budget.chargeLimitMA >= chargeLimitMA_ + BUDGET_RAISE_MARGIN_MA) {
+        next = budget.chargeLimitMA;
+    }
+    if (next == chargeLimitMA_) {
+        return false;
+    }
+    chargeLimitMA_ = next;
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef BQ25895_POWER_BUDGET_H
+#define BQ25895_POWER_BUDGET_H
+
+#include <stdint.h>
+
+struct BQ25895PowerBudgetConfig {
+  uint8_t efficiencyPercent = 90;       // VBUS to VSYS buck efficiency
+  uint16_t batteryDischargeMA = 3000;   // Current the battery may supplement into VSYS
+  uint16_t vsysMinMV = 3500;            // VSYS below this counts as a sag (SYS_MIN default)
+  bool rebalance = false;               // Lower ICHG (and raise IINLIM) to make room for the load
+  uint16_t minChargeMA = 0;             // Rebalancing never takes ICHG below this
+  uint16_t adapterLimitMA = 0;          // Known adapter capability IINLIM may be raised to (0 = never)
+};
+
+// Power available to the system load, from the last getMetrics() sample.
+// On input power the charger serves VSYS first: load beyond loadBudgetMW is taken from
+// charging, and load beyond inputMW is supplemented by the battery.
+struct BQ25895PowerBudget {
+  bool valid = false;
+  bool externalPower = false;
+  uint16_t inputLimitMA = 0;            // IINLIM in effect
+  uint32_t inputMW = 0;                 // Adapter power reaching VSYS (VBUS x IINLIM x efficiency)
+  uint32_t batteryMW = 0;               // Supplement power (BATV x batteryDischargeMA)
+  uint32_t chargeMW = 0;                // Charging demand at the ICHG target
+  uint32_t loadMW = 0;                  // Declared system load
+  uint32_t loadBudgetMW = 0;            // Load that leaves charging untouched (0 on battery)
+  uint32_t availableMW = 0;             // Load VSYS can carry, including battery supplement
+  int32_t headroomMW = 0;               // loadBudgetMW - loadMW on input, availableMW - loadMW on battery
+  uint8_t headroomPercent = 0;          // Positive headroom as a share of the budget it came from
+  uint16_t chargeLimitMA = 0;           // ICHG that fits beside the load (rebalancing target)
+  bool vsysSagging = false;             // VSYS measured below vsysMinMV
+};
+
+// One getMetrics() sample as needed by the budget
+struct BQ25895PowerSample {
+  bool externalPower = false;
+  uint16_t inputMV = 0;
+  uint16_t systemMV = 0;
+  uint16_t batteryMV = 0;
+  uint16_t inputLimitMA = 0;            // Programmed IINLIM
+  uint16_t chargeDemandMA = 0;          // ICHG the other charge policies ask for
+};
+
+// Integer power arithmetic (mV x mA / 1000); the charge limit moves down at once and
+// back up only after two ICHG steps of room, so load jitter does not cost bus writes.
+class BQ25895PowerBudgeter {
+public:
+  void configure(const BQ25895PowerBudgetConfig& config);
+  void disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+  bool rebalancing() const { return enabled_ && config_.rebalance; }
+  const BQ25895PowerBudgetConfig& config() const { return config_; }
+
+  void setLoad(uint32_t loadMW) { loadMW_ = loadMW; }
+  uint32_t load() const { return loadMW_; }
+
+  // Returns true when the rebalanced ICHG limit changed
+  bool update(const BQ25895PowerSample& sample);
+  uint16_t chargeLimitMA() const { return chargeLimitMA_; }  // 0 = no limit
+  // IINLIM needed to carry load and charging, capped at adapterLimitMA (0 = no raise needed)
+  uint16_t inputLimitRequestMA() const { return inputRequestMA_; }
+
+  const BQ25895PowerBudget& budget() const { return budget_; }
+
+private:
+  BQ25895PowerBudgetConfig config_;
+  bool enabled_ = false;
+  uint32_t loadMW_ = 0;
+  uint16_t chargeLimitMA_ = 0;
+  uint16_t inputRequestMA_ = 0;
+  BQ25895PowerBudget budget_;
+};
+
+#endif // BQ25895_POWER_BUDGET_H
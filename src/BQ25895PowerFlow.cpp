@@ -0,0 +1,54 @@
+#include "BQ25895PowerFlow.h"
+
+void BQ25895PowerFlowEstimator::update(const BQ25895PowerFlowSample& sample) {
+    if (!enabled_ || sample.batteryMV == 0) {
+        return;
+    }
+
+    BQ25895PowerFlow flow;
+    flow.valid = true;
+    flow.externalPower = sample.externalPower;
+    flow.inputLimitMA = sample.inputLimitMA;
+    flow.vindpm = sample.vindpm;
+    flow.iindpm = sample.iindpm;
+    uint32_t chargeMW = static_cast<uint32_t>(sample.batteryMV) * sample.chargeMA / 1000;
+
+    if (sample.externalPower) {
+        flow.batteryMW = static_cast<int32_t>(chargeMW);
+        flow.inputMaxMW = static_cast<uint32_t>(sample.inputMV) * sample.inputLimitMA / 1000;
+        uint32_t deliverableMW = flow.inputMaxMW * efficiencyPercent_ / 100;
+        flow.systemMaxMW = deliverableMW > chargeMW ? deliverableMW - chargeMW : 0;
+        flow.inputAmbiguous = !sample.iindpm;
+
+        if (sample.iindpm) {
+            // Input current sits at the limit: the load is what charging leaves over
+            flow.confidence = BQ25895PowerFlowConfidence::MEASURED;
+            flow.inputMW = flow.inputMaxMW;
+            flow.systemMW = flow.systemMaxMW;
+        } else if (sample.declaredLoadMW != 0) {
+            flow.confidence = BQ25895PowerFlowConfidence::INFERRED;
+            flow.systemMW = sample.declaredLoadMW < flow.systemMaxMW ? sample.declaredLoadMW : flow.systemMaxMW;
+            flow.inputMW = (flow.systemMW + chargeMW) * 100 / efficiencyPercent_;
+        } else {
+            // Only charging is known: a lower bound on input, an upper bound on the load
+            flow.confidence = BQ25895PowerFlowConfidence::BOUNDED;
+            flow.inputMW = chargeMW * 100 / efficiencyPercent_;
+        }
+        if (flow.inputMW > flow.inputMaxMW) {
+            flow.inputMW = flow.inputMaxMW;
+        }
+        uint32_t deliveredMW = flow.systemMW + chargeMW;
+        flow.lossMW = flow.inputMW > deliveredMW ? flow.inputMW - deliveredMW : 0;
+    } else {
+        // On battery the load is the discharge, which only the application knows
+        uint32_t dischargeMW = sample.declaredLoadMW;
+        if (dischargeMW == 0) {
+            dischargeMW = static_cast<uint32_t>(sample.batteryMV) * sample.dischargeMA / 1000;
+        }
+        flow.confidence = dischargeMW != 0 ? BQ25895PowerFlowConfidence::INFERRED
+                                           : BQ25895PowerFlowConfidence::NONE;
+        flow.systemMW = dischargeMW;
+        flow.batteryMW = -static_cast<int32_t>(dischargeMW);
+    }
+    flow_ = flow;
+}
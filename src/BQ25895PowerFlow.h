@@ -0,0 +1,62 @@
+#ifndef BQ25895_POWER_FLOW_H
+#define BQ25895_POWER_FLOW_H
+
+#include <stdint.h>
+
+// How much of the power flow was measured rather than assumed
+enum class BQ25895PowerFlowConfidence : uint8_t {
+  NONE = 0,       // No sample, or on battery with no declared load
+  BOUNDED = 1,    // Input current somewhere below IINLIM (or held by VINDPM): upper bounds only
+  INFERRED = 2,   // Derived from the declared system load
+  MEASURED = 3    // IINLIM regulation pins the input current; the load follows from it
+};
+
+// One getMetrics() sample as needed by the estimator
+struct BQ25895PowerFlowSample {
+  bool externalPower = false;
+  uint16_t inputMV = 0;
+  uint16_t batteryMV = 0;
+  uint16_t chargeMA = 0;              // ICHGR
+  uint16_t inputLimitMA = 0;          // Effective input limit (REG13 IDPM_LIM)
+  bool vindpm = false;                // REG13 VDPM_STAT
+  bool iindpm = false;                // REG13 IDPM_STAT
+  uint32_t declaredLoadMW = 0;        // setSystemLoad() (0 = not declared)
+  uint16_t dischargeMA = 0;           // setBatteryLoadCurrent() (0 = not declared)
+};
+
+// Where the power goes, in mW. batteryMW is positive while charging.
+struct BQ25895PowerFlow {
+  bool valid = false;
+  bool externalPower = false;
+  BQ25895PowerFlowConfidence confidence = BQ25895PowerFlowConfidence::NONE;
+  bool inputAmbiguous = false;        // No IINLIM regulation, so the input current is not known
+  uint32_t inputMW = 0;
+  uint32_t inputMaxMW = 0;            // VBUS x effective input limit
+  int32_t batteryMW = 0;
+  uint32_t systemMW = 0;
+  uint32_t systemMaxMW = 0;           // Largest load consistent with the sample
+  uint32_t lossMW = 0;                // Converter loss (input - system - charging)
+  uint16_t inputLimitMA = 0;
+  bool vindpm = false;
+  bool iindpm = false;
+};
+
+// Integer-only power balance: input x efficiency = system load + battery charging.
+// The BQ25895 measures no input or discharge current, so the balance is closed with
+// IINLIM when the charger regulates on it, and with the application's declared load otherwise.
+class BQ25895PowerFlowEstimator {
+public:
+  void setEnabled(bool enabled) { enabled_ = enabled; if (!enabled) flow_ = BQ25895PowerFlow(); }
+  bool enabled() const { return enabled_; }
+  void setEfficiency(uint8_t percent) { efficiencyPercent_ = percent > 0 && percent <= 100 ? percent : 100; }
+
+  void update(const BQ25895PowerFlowSample& sample);
+  const BQ25895PowerFlow& flow() const { return flow_; }
+
+private:
+  bool enabled_ = false;
+  uint8_t efficiencyPercent_ = 90;    // VBUS to VSYS/battery
+  BQ25895PowerFlow flow_;
+};
+
+#endif // BQ25895_POWER_FLOW_H
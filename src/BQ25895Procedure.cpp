@@ -0,0 +1,66 @@
+#include "BQ25895Procedure.h"
+
+bool BQ25895ProcedureRunner::start(BQ25895ProcedureId id, uint32_t now, uint32_t timeoutMs) {
+    if (running()) {
+        return false;
+    }
+    state_ = BQ25895ProcedureState();
+    state_.id = id;
+    state_.status = BQ25895ProcedureStatus::RUNNING;
+    state_.started = now;
+    timeoutMs_ = timeoutMs;
+    deadline_ = now + timeoutMs;
+    waiting_ = false;
+    return true;
+}
+
+bool BQ25895ProcedureRunner::ready(uint32_t now) const {
+    return running() && (!waiting_ || static_cast<int32_t>(now - wakeAt_) >= 0);
+}
+
+uint32_t BQ25895ProcedureRunner::remainingWaitMs(uint32_t now) const {
+    if (!running() || !waiting_ || static_cast<int32_t>(now - wakeAt_) >= 0) {
+        return 0;
+    }
+    return wakeAt_ - now;
+}
+
+bool BQ25895ProcedureRunner::apply(const BQ25895StepResult& result, uint32_t now) {
+    switch (result.action) {
+        case BQ25895StepResult::NEXT:
+            state_.step++;
+            break;
+        case BQ25895StepResult::JUMP:
+            state_.step = result.target;
+            break;
+        case BQ25895StepResult::POLL:
+            // Only polling is bounded by the deadline; a scheduled wait always completes
+            if (static_cast<int32_t>(now - deadline_) >= 0) {
+                finish(BQ25895ProcedureStatus::FAILED, now, "Procedure timed out");
+                return true;
+            }
+            break;
+        case BQ25895StepResult::DONE:
+            finish(BQ25895ProcedureStatus::DONE, now, nullptr);
+            return true;
+        case BQ25895StepResult::FAIL:
+            finish(BQ25895ProcedureStatus::FAILED, now, result.failure);
+            return true;
+    }
+    waiting_ = result.delayMs != 0;
+    wakeAt_ = now + result.delayMs;
+    return false;
+}
+
+void BQ25895ProcedureRunner::abort(uint32_t now, const char* reason) {
+    if (running()) {
+        finish(BQ25895ProcedureStatus::FAILED, now, reason);
+    }
+}
+
+void BQ25895ProcedureRunner::finish(BQ25895ProcedureStatus status, uint32_t now, const char* failure) {
+    state_.status = status;
+    state_.finished = now;
+    state_.failure = failure;
+    waiting_ = false;
+}
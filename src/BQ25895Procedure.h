@@ -0,0 +1,84 @@
+#ifndef BQ25895_PROCEDURE_H
+#define BQ25895_PROCEDURE_H
+
+#include <stdint.h>
+
+// Steps one tick() may run back to back before yielding to the main loop
+#define BQ25895_PROCEDURE_STEPS_PER_TICK 8
+
+// Multi-step operations run by the procedure engine
+enum class BQ25895ProcedureId : uint8_t {
+  NONE = 0,
+  FACTORY_RESET = 1,     // REG_RST, wait, confirm the reset bit cleared
+  USB_RECOVERY = 2,      // Settle, check VBUS detection, re-detect (FORCE_DPDM), reset as a last resort
+  EMERGENCY_ENTER = 3,   // Charging off, minimum input, detection off, faults cleared
+  EMERGENCY_EXIT = 4,    // Re-initialize with the current configuration
+  FORCE_RESTART_CHARGING = 5   // Charging off, settle, input limit forced, charging back on
+};
+
+enum class BQ25895ProcedureStatus : uint8_t {
+  IDLE = 0,
+  RUNNING = 1,
+  DONE = 2,
+  FAILED = 3
+};
+
+// What a step function asks the engine to do next
+struct BQ25895StepResult {
+  enum Action : uint8_t { NEXT, JUMP, POLL, DONE, FAIL };
+  Action action;
+  uint32_t delayMs;
+  const char* failure;
+  uint8_t target;                    // JUMP: step to continue at
+
+  static BQ25895StepResult next(uint32_t delayMs = 0) { BQ25895StepResult r = {NEXT, delayMs, nullptr, 0}; return r; }
+  static BQ25895StepResult jump(uint8_t step, uint32_t delayMs = 0) { BQ25895StepResult r = {JUMP, delayMs, nullptr, step}; return r; }
+  static BQ25895StepResult poll(uint32_t delayMs) { BQ25895StepResult r = {POLL, delayMs, nullptr, 0}; return r; }
+  static BQ25895StepResult done() { BQ25895StepResult r = {DONE, 0, nullptr, 0}; return r; }
+  static BQ25895StepResult fail(const char* reason) { BQ25895StepResult r = {FAIL, 0, reason, 0}; return r; }
+};
+
+struct BQ25895ProcedureState {
+  BQ25895ProcedureId id = BQ25895ProcedureId::NONE;   // Running, or the last one to finish
+  BQ25895ProcedureStatus status = BQ25895ProcedureStatus::IDLE;
+  uint8_t step = 0;
+  uint8_t ticks = 0;                 // tick() calls that ran at least one step (saturates)
+  uint32_t started = 0;
+  uint32_t finished = 0;
+  const char* failure = nullptr;     // Static string, set when FAILED
+};
+
+// Cooperative step sequencer. It holds no step code: the owner runs the step for id()/step()
+// whenever ready() and feeds the result back through apply(). A step either continues at
+// once or after a delay (NEXT, or JUMP to another step), or re-runs itself after a delay
+// (POLL) until the procedure's deadline; nothing ever sleeps.
+class BQ25895ProcedureRunner {
+public:
+  bool start(BQ25895ProcedureId id, uint32_t now, uint32_t timeoutMs);
+  bool running() const { return state_.status == BQ25895ProcedureStatus::RUNNING; }
+  bool ready(uint32_t now) const;
+  uint32_t remainingWaitMs(uint32_t now) const;
+  void wake() { waiting_ = false; }   // Blocking callers: the wait was spent elsewhere
+
+  BQ25895ProcedureId id() const { return state_.id; }
+  uint8_t step() const { return state_.step; }
+  uint32_t timeoutMs() const { return timeoutMs_; }
+
+  // Returns true when the procedure finished (DONE or FAILED)
+  bool apply(const BQ25895StepResult& result, uint32_t now);
+  void noteTick() { if (state_.ticks < 0xFF) state_.ticks++; }
+  void abort(uint32_t now, const char* reason);
+
+  const BQ25895ProcedureState& state() const { return state_; }
+
+private:
+  void finish(BQ25895ProcedureStatus status, uint32_t now, const char* failure);
+
+  BQ25895ProcedureState state_;
+  uint32_t timeoutMs_ = 0;
+  uint32_t deadline_ = 0;
+  uint32_t wakeAt_ = 0;
+  bool waiting_ = false;
+};
+
+#endif // BQ25895_PROCEDURE_H
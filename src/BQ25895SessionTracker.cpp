@@ -0,0 +1,96 @@
+#include "BQ25895SessionTracker.h"
+#include "BQ25895ChargePredictor.h"
+
+// Longer gaps between samples still count toward phase times, but only this much
+// of the stale current is integrated into charge and energy
+#define SESSION_MAX_INTEGRATION_MS 60000UL
+
+void BQ25895SessionTracker::setEnabled(bool enabled) {
+    enabled_ = enabled;
+    if (!enabled) {
+        active_ = false;
+        waitForDetach_ = false;
+    }
+}
+
+void BQ25895SessionTracker::noteFaults(uint8_t categories) {
+    if (active_ && categories) {
+        session_.faultCategories |= categories;
+        if (session_.faultEvents < 0xFFFF) {
+            session_.faultEvents++;
+        }
+    }
+}
+
+void BQ25895SessionTracker::finish(BQ25895SessionEnd end, uint32_t timestamp) {
+    session_.end = end;
+    session_.durationMs = timestamp - session_.startTime;
+    last_ = session_;
+    active_ = false;
+}
+
+void BQ25895SessionTracker::update(const BQ25895SessionSample& sample) {
+    if (!enabled_) {
+        return;
+    }
+
+    if (!sample.externalPower) {
+        waitForDetach_ = false;
+        if (active_) {
+            finish(BQ25895SessionEnd::DETACHED, sample.timestamp);
+        }
+        return;
+    }
+
+    if (!active_) {
+        if (waitForDetach_) {
+            return;
+        }
+        active_ = true;
+        session_ = BQ25895ChargeSession();
+        session_.index = ++count_;
+        session_.startTime = sample.timestamp;
+        session_.startBatteryMV = sample.batteryMV;
+        chargeResidual_ = 0;
+        energyResidual_ = 0;
+        previous_ = sample;
+    }
+
+    // The interval since the last sample is attributed to the state seen at its start
+    uint32_t dt = sample.timestamp - previous_.timestamp;
+    if (previous_.chargeStatus == BQ25895_CHRG_STAT_PRE_CHARGE) {
+        session_.preChargeMs += dt;
+    } else if (previous_.chargeStatus == BQ25895_CHRG_STAT_FAST_CHARGE) {
+        if (previous_.batteryMV + BQ25895ChargePredictor::kCvMarginMV >= previous_.chargeVoltageMV) {
+            session_.constantVoltageMs += dt;
+        } else {
+            session_.fastChargeMs += dt;
+        }
+    }
+    if (previous_.vindpm) session_.vindpmMs += dt;
+    if (previous_.iindpm) session_.iindpmMs += dt;
+
+    uint32_t integrated = dt < SESSION_MAX_INTEGRATION_MS ? dt : SESSION_MAX_INTEGRATION_MS;
+    chargeResidual_ += static_cast<uint32_t>(previous_.chargeMA) * integrated;
+    session_.chargeUAh += chargeResidual_ / 3600;
+    chargeResidual_ %= 3600;
+    uint32_t milliwatts = static_cast<uint32_t>(previous_.batteryMV) * previous_.chargeMA / 1000;
+    energyResidual_ += milliwatts * integrated;
+    session_.energyMWh += energyResidual_ / 3600000UL;
+    energyResidual_ %= 3600000UL;
+
+    session_.durationMs = sample.timestamp - session_.startTime;
+    session_.endBatteryMV = sample.batteryMV;
+    if (sample.chargeMA > session_.peakChargeMA) {
+        session_.peakChargeMA = sample.chargeMA;
+    }
+    if (sample.tsVoltage > 0 && (session_.minTsVoltage == 0 || sample.tsVoltage < session_.minTsVoltage)) {
+        session_.minTsVoltage = sample.tsVoltage;
+    }
+    previous_ = sample;
+
+    if (sample.chargeStatus == BQ25895_CHRG_STAT_TERMINATED) {
+        waitForDetach_ = true;
+        finish(BQ25895SessionEnd::TERMINATED, sample.timestamp);
+    }
+}
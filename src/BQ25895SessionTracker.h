@@ -0,0 +1,74 @@
+#ifndef BQ25895_SESSION_TRACKER_H
+#define BQ25895_SESSION_TRACKER_H
+
+#include <stdint.h>
+
+enum class BQ25895SessionEnd : uint8_t {
+  ACTIVE = 0,       // Still in progress
+  DETACHED = 1,     // VBUS removed
+  TERMINATED = 2    // Charge completed (VBUS may still be present)
+};
+
+// Running totals for one charge session (VBUS attach to detach or termination)
+struct BQ25895ChargeSession {
+  uint16_t index = 0;                // 1-based session number since boot (0 = none yet)
+  BQ25895SessionEnd end = BQ25895SessionEnd::ACTIVE;
+  uint32_t startTime = 0;            // millis() at attach
+  uint32_t durationMs = 0;
+  uint32_t chargeUAh = 0;            // Charge delivered into the battery
+  uint32_t energyMWh = 0;            // Energy delivered into the battery (BATV * ICHGR)
+  uint32_t preChargeMs = 0;
+  uint32_t fastChargeMs = 0;         // Constant current
+  uint32_t constantVoltageMs = 0;
+  uint32_t vindpmMs = 0;             // Input voltage regulation active (REG13 VDPM_STAT)
+  uint32_t iindpmMs = 0;             // Input current regulation active (REG13 IDPM_STAT)
+  uint16_t startBatteryMV = 0;
+  uint16_t endBatteryMV = 0;
+  uint16_t peakChargeMA = 0;
+  uint16_t minTsVoltage = 0;         // Lowest TS voltage: NTC hottest point (0 = not sampled)
+  uint8_t faultCategories = 0;       // BQ25895FaultMask bits seen during the session
+  uint16_t faultEvents = 0;
+};
+
+// One getMetrics() sample as needed by the tracker
+struct BQ25895SessionSample {
+  uint32_t timestamp = 0;
+  bool externalPower = false;
+  uint8_t chargeStatus = 0;          // ChargeStatus (REG0B CHRG_STAT)
+  uint16_t batteryMV = 0;
+  uint16_t chargeMA = 0;
+  uint16_t tsVoltage = 0;
+  uint16_t chargeVoltageMV = 0;      // VREG target, to split fast charge into CC and CV
+  bool vindpm = false;
+  bool iindpm = false;
+};
+
+// O(1) memory: the active session plus a copy of the last completed one
+class BQ25895SessionTracker {
+public:
+  void setEnabled(bool enabled);
+  bool enabled() const { return enabled_; }
+
+  void update(const BQ25895SessionSample& sample);
+  void noteFaults(uint8_t categories);
+
+  bool active() const { return active_; }
+  const BQ25895ChargeSession& current() const { return active_ ? session_ : last_; }
+  const BQ25895ChargeSession& last() const { return last_; }
+  uint16_t sessionCount() const { return count_; }
+
+private:
+  void finish(BQ25895SessionEnd end, uint32_t timestamp);
+
+  bool enabled_ = false;
+  bool active_ = false;
+  bool waitForDetach_ = false;       // Terminated while attached; next session needs a new attach
+  uint16_t count_ = 0;
+  BQ25895ChargeSession session_;
+  BQ25895ChargeSession last_;
+  BQ25895SessionSample previous_;
+  uint32_t chargeResidual_ = 0;      // mA*ms below one uAh
+  uint32_t energyResidual_ = 0;      // mW*ms below one mWh
+};
+
+#endif // BQ25895_SESSION_TRACKER_H
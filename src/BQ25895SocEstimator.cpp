@@ -0,0 +1,142 @@
+#include "BQ25895SocEstimator.h"
+
+const BQ25895OcvPoint BQ25895DefaultOcvTable[BQ25895_DEFAULT_OCV_POINTS] = {
+    {3300, 0},   {3500, 30},  {3600, 80},  {3680, 150}, {3730, 250},
+    {3780, 350}, {3820, 450}, {3870, 550}, {3930, 650}, {4000, 750},
+    {4080, 850}, {4150, 950}, {4200, 1000}
+};
+
+void BQ25895SocEstimator::configure(const BQ25895SocConfig& config) {
+    config_ = config;
+    if (!config_.ocvTable || config_.ocvPoints == 0) {
+        config_.ocvTable = BQ25895DefaultOcvTable;
+        config_.ocvPoints = BQ25895_DEFAULT_OCV_POINTS;
+    }
+    reset();
+}
+
+void BQ25895SocEstimator::reset() {
+    started_ = false;
+    currentMA_ = 0;
+    chargeUAh_ = 0;
+    residualMAms_ = 0;
+    throughputUAh_ = 0;
+    anchorConfidence_ = 0;
+    resting_ = false;
+    restAnchored_ = false;
+}
+
+uint16_t BQ25895SocEstimator::ocvToPermille(const BQ25895OcvPoint* table, uint8_t points, uint16_t millivolts) {
+    if (millivolts <= table[0].millivolts) {
+        return table[0].permille;
+    }
+    for (uint8_t i = 1; i < points; i++) {
+        if (millivolts <= table[i].millivolts) {
+            const BQ25895OcvPoint& lo = table[i - 1];
+            const BQ25895OcvPoint& hi = table[i];
+            return lo.permille + static_cast<uint16_t>(
+                static_cast<uint32_t>(millivolts - lo.millivolts) * (hi.permille - lo.permille) /
+                (hi.millivolts - lo.millivolts));
+        }
+    }
+    return table[points - 1].permille;
+}
+
+void BQ25895SocEstimator::anchor(uint16_t permille, uint8_t confidence) {
+    chargeUAh_ = static_cast<uint32_t>(permille) * config_.capacityMAh;
+    residualMAms_ = 0;
+    throughputUAh_ = 0;
+    anchorConfidence_ = confidence;
+}
+
+void BQ25895SocEstimator::update(uint32_t timestamp, uint16_t batteryMV, uint16_t chargeMA,
+                                 bool externalPower, bool terminated) {
+    if (!enabled() || batteryMV == 0) {
+        return;
+    }
+
+    // Battery current: ICHGR while charging, the application-reported load on battery
+    int16_t current = 0;
+    if (chargeMA > 0) {
+        current = static_cast<int16_t>(chargeMA);
+    } else if (!externalPower) {
+        current = -static_cast<int16_t>(loadMA_);
+    }
+
+    if (!started_) {
+        started_ = true;
+        lastSample_ = timestamp;
+        restStart_ = timestamp;
+        resting_ = (current < 0 ? -current : current) <= config_.restCurrentMA;
+        currentMA_ = current;
+        anchor(ocvToPermille(config_.ocvTable, config_.ocvPoints, batteryMV), BQ25895_SOC_CONFIDENCE_GUESS);
+        return;
+    }
+
+    // Integrate the previous sample's current over the interval
+    uint32_t dt = timestamp - lastSample_;
+    if (dt > config_.maxSampleGapMs) {
+        dt = config_.maxSampleGapMs;
+    }
+    lastSample_ = timestamp;
+
+    residualMAms_ += static_cast<int32_t>(currentMA_) * static_cast<int32_t>(dt);
+    int32_t wholeUAh = residualMAms_ / 3600;
+    residualMAms_ -= wholeUAh * 3600;
+
+    uint32_t fullUAh = static_cast<uint32_t>(config_.capacityMAh) * 1000;
+    if (wholeUAh >= 0) {
+        chargeUAh_ = (fullUAh - chargeUAh_ > static_cast<uint32_t>(wholeUAh)) ? chargeUAh_ + wholeUAh : fullUAh;
+        throughputUAh_ += wholeUAh;
+    } else {
+        uint32_t drawn = static_cast<uint32_t>(-wholeUAh);
+        chargeUAh_ = chargeUAh_ > drawn ? chargeUAh_ - drawn : 0;
+        throughputUAh_ += drawn;
+    }
+    currentMA_ = current;
+
+    if (terminated) {
+        anchor(1000, BQ25895_SOC_CONFIDENCE_FULL);
+        return;
+    }
+
+    // Rest detection for OCV correction
+    uint16_t magnitude = static_cast<uint16_t>(current < 0 ? -current : current);
+    if (magnitude > config_.restCurrentMA) {
+        resting_ = false;
+        restAnchored_ = false;
+        return;
+    }
+    if (!resting_) {
+        resting_ = true;
+        restStart_ = timestamp;
+    }
+    if (!restAnchored_ && timestamp - restStart_ >= config_.restTimeMs) {
+        restAnchored_ = true;
+        uint16_t ocv = ocvToPermille(config_.ocvTable, config_.ocvPoints, batteryMV);
+        uint16_t counted = static_cast<uint16_t>(chargeUAh_ / config_.capacityMAh);
+        // A trusted count is blended; a weak one is replaced
+        uint16_t corrected = state().confidence >= 50 ? static_cast<uint16_t>((counted + ocv) / 2) : ocv;
+        anchor(corrected, BQ25895_SOC_CONFIDENCE_REST);
+    }
+}
+
+BQ25895SocState BQ25895SocEstimator::state() const {
+    BQ25895SocState state;
+    if (!enabled() || !started_) {
+        return state;
+    }
+
+    state.valid = true;
+    state.socPermille = static_cast<uint16_t>(chargeUAh_ / config_.capacityMAh);
+    state.socPercent = static_cast<uint8_t>((state.socPermille + 5) / 10);
+    state.remainingMAh = static_cast<uint16_t>(chargeUAh_ / 1000);
+    state.batteryCurrentMA = currentMA_;
+    state.atRest = resting_;
+
+    // One point per 2% of capacity counted (capacity * 20 uAh)
+    uint32_t lost = throughputUAh_ / (static_cast<uint32_t>(config_.capacityMAh) * 20);
+    uint32_t floor = BQ25895_SOC_CONFIDENCE_FLOOR;
+    state.confidence = static_cast<uint8_t>(anchorConfidence_ > floor + lost ? anchorConfidence_ - lost : floor);
+    return state;
+}
@@ -0,0 +1,77 @@
+#ifndef BQ25895_SOC_ESTIMATOR_H
+#define BQ25895_SOC_ESTIMATOR_H
+
+#include <stdint.h>
+
+// Open-circuit voltage to state of charge (permille) breakpoint, ascending by voltage
+struct BQ25895OcvPoint {
+  uint16_t millivolts;
+  uint16_t permille;
+};
+
+// Typical single-cell Li-ion (NMC/LCO, 4.2V) rest curve
+#define BQ25895_DEFAULT_OCV_POINTS 13
+extern const BQ25895OcvPoint BQ25895DefaultOcvTable[BQ25895_DEFAULT_OCV_POINTS];
+
+struct BQ25895SocConfig {
+  uint16_t capacityMAh = 0;            // Design capacity; 0 disables the estimator
+  uint16_t restCurrentMA = 20;         // Battery current at or below this counts as rest
+  uint32_t restTimeMs = 600000;        // Rest needed before the OCV is trusted (10 min)
+  uint32_t maxSampleGapMs = 60000;     // Longer gaps are integrated as this long
+  const BQ25895OcvPoint* ocvTable = BQ25895DefaultOcvTable;
+  uint8_t ocvPoints = BQ25895_DEFAULT_OCV_POINTS;
+};
+
+// Confidence (0-100) in the current estimate
+#define BQ25895_SOC_CONFIDENCE_GUESS 40    // Initial OCV guess under unknown load
+#define BQ25895_SOC_CONFIDENCE_REST 90     // After a rested OCV correction
+#define BQ25895_SOC_CONFIDENCE_FULL 100    // After charge termination
+#define BQ25895_SOC_CONFIDENCE_FLOOR 10
+
+struct BQ25895SocState {
+  bool valid = false;              // At least one sample since configure()
+  uint16_t socPermille = 0;        // 0-1000
+  uint8_t socPercent = 0;
+  uint16_t remainingMAh = 0;
+  uint8_t confidence = 0;          // Drops by 1 per 2% of capacity counted since the last anchor
+  int16_t batteryCurrentMA = 0;    // Last net battery current (+ charging, - discharging)
+  bool atRest = false;
+};
+
+// Coulomb counter with OCV correction. Integer only, O(1) per sample.
+// The BQ25895 measures charge current (ICHGR) but not discharge current; while on
+// battery the estimator integrates the load reported through setLoadCurrent().
+class BQ25895SocEstimator {
+public:
+  void configure(const BQ25895SocConfig& config);
+  void reset();
+  bool enabled() const { return config_.capacityMAh > 0; }
+  const BQ25895SocConfig& config() const { return config_; }
+
+  void setLoadCurrent(uint16_t currentMA) { loadMA_ = currentMA; }
+  uint16_t loadCurrent() const { return loadMA_; }
+  void update(uint32_t timestamp, uint16_t batteryMV, uint16_t chargeMA,
+              bool externalPower, bool terminated);
+
+  BQ25895SocState state() const;
+
+  static uint16_t ocvToPermille(const BQ25895OcvPoint* table, uint8_t points, uint16_t millivolts);
+
+private:
+  void anchor(uint16_t permille, uint8_t confidence);
+
+  BQ25895SocConfig config_;
+  uint16_t loadMA_ = 0;
+  bool started_ = false;
+  uint32_t lastSample_ = 0;
+  int16_t currentMA_ = 0;
+  uint32_t chargeUAh_ = 0;          // Remaining charge in uAh
+  int32_t residualMAms_ = 0;        // Sub-uAh remainder (mA*ms, one uAh = 3600)
+  uint32_t throughputUAh_ = 0;      // Charge counted since the last anchor
+  uint8_t anchorConfidence_ = 0;
+  uint32_t restStart_ = 0;
+  bool resting_ = false;
+  bool restAnchored_ = false;       // OCV already applied during this rest period
+};
+
+#endif // BQ25895_SOC_ESTIMATOR_H
@@ -0,0 +1,52 @@
+#include "BQ25895StepProfile.h"
+
+bool BQ25895StepProfile::configure(const BQ25895ChargeStage* stages, uint8_t count, uint16_t hysteresisMV) {
+    if (!stages || count == 0 || count > BQ25895_MAX_CHARGE_STAGES) {
+        return false;
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        if (stages[i].aboveMV <= stages[i - 1].aboveMV) {
+            return false;
+        }
+    }
+
+    // Copied so callers can build the table on the stack
+    for (uint8_t i = 0; i < count; i++) {
+        stages_[i] = stages[i];
+    }
+    count_ = count;
+    stage_ = 0;
+    hysteresisMV_ = hysteresisMV;
+    started_ = false;
+    return true;
+}
+
+bool BQ25895StepProfile::update(uint16_t batteryMV) {
+    if (count_ == 0 || batteryMV == 0) {
+        return false;
+    }
+
+    uint8_t next = stage_;
+    if (!started_) {
+        // First sample: plain threshold lookup
+        next = 0;
+        while (next + 1 < count_ && batteryMV >= stages_[next + 1].aboveMV) {
+            next++;
+        }
+        started_ = true;
+        stage_ = next;
+        return true;
+    }
+
+    while (next + 1 < count_ && batteryMV >= stages_[next + 1].aboveMV) {
+        next++;
+    }
+    while (next > 0 && static_cast<uint32_t>(batteryMV) + hysteresisMV_ < stages_[next].aboveMV) {
+        next--;
+    }
+    if (next == stage_) {
+        return false;
+    }
+    stage_ = next;
+    return true;
+}
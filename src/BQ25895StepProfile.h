@@ -0,0 +1,49 @@
+#ifndef BQ25895_STEP_PROFILE_H
+#define BQ25895_STEP_PROFILE_H
+
+#include <stdint.h>
+
+// One stage of a step-charging profile: applies while BATV is at or above aboveMV
+struct BQ25895ChargeStage {
+  uint16_t aboveMV;             // Entry threshold (the first stage normally uses 0)
+  uint16_t chargeCurrentMA;     // ICHG for this stage
+  uint16_t chargeVoltageMV;     // VREG for this stage
+};
+
+#define BQ25895_MAX_CHARGE_STAGES 8
+
+struct BQ25895StepChargeState {
+  bool active = false;
+  uint8_t stage = 0;            // Index into the profile
+  uint8_t stageCount = 0;
+  uint16_t chargeCurrentMA = 0; // Targets of the current stage
+  uint16_t chargeVoltageMV = 0;
+  uint16_t transitions = 0;     // Stage changes written to the charger
+  unsigned long lastTransition = 0;
+};
+
+// Stage selection with hysteresis. Thresholds are ascending; the stage rises as soon as
+// BATV reaches the next threshold and falls back only once BATV is hysteresisMV below
+// the current stage's threshold, so the IR drop after lowering ICHG does not bounce it.
+class BQ25895StepProfile {
+public:
+  // false if the table is empty, too long or not strictly ascending (profile left unchanged)
+  bool configure(const BQ25895ChargeStage* stages, uint8_t count, uint16_t hysteresisMV);
+  void clear() { count_ = 0; }
+  bool active() const { return count_ > 0; }
+  uint8_t count() const { return count_; }
+  uint8_t stage() const { return stage_; }
+  const BQ25895ChargeStage& current() const { return stages_[stage_]; }
+
+  // Returns true when the stage changed (or on the first sample after configure())
+  bool update(uint16_t batteryMV);
+
+private:
+  BQ25895ChargeStage stages_[BQ25895_MAX_CHARGE_STAGES];
+  uint8_t count_ = 0;
+  uint8_t stage_ = 0;
+  uint16_t hysteresisMV_ = 0;
+  bool started_ = false;
+};
+
+#endif // BQ25895_STEP_PROFILE_H
@@ -0,0 +1,98 @@
+#include "BQ25895TempZones.h"
+
+const BQ25895TempZoneRule BQ25895DefaultZoneRules[BQ25895_DEFAULT_ZONE_RULES] = {
+    {0,    BQ25895TempZone::HOT,    0,   0},
+    {2307, BQ25895TempZone::WARM,   100, 4100},   // VHTF (48.25%)
+    {2400, BQ25895TempZone::NORMAL, 100, 0},
+    {4030, BQ25895TempZone::COOL,   50,  0},
+    {4424, BQ25895TempZone::COLD,   0,   0}       // VLTF (73.25%)
+};
+
+bool BQ25895TempZones::configure(const BQ25895TempZoneConfig& config) {
+    if (!config.rules || config.ruleCount == 0 || config.ruleCount > BQ25895_MAX_ZONE_RULES) {
+        return false;
+    }
+    for (uint8_t i = 0; i < config.ruleCount; i++) {
+        if (config.rules[i].chargePercent > 100 ||
+            (i > 0 && config.rules[i].tsAboveMV <= config.rules[i - 1].tsAboveMV)) {
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < config.ruleCount; i++) {
+        rules_[i] = config.rules[i];
+    }
+    count_ = config.ruleCount;
+    index_ = 0;
+    normal_ = 0;
+    for (uint8_t i = 0; i < count_; i++) {
+        if (rules_[i].zone == BQ25895TempZone::NORMAL) {
+            normal_ = i;
+        }
+    }
+    hysteresisMV_ = config.hysteresisMV;
+    started_ = false;
+    hardwareZone_ = BQ25895TempZone::UNKNOWN;
+    transitions_ = 0;
+    return true;
+}
+
+BQ25895TempZone BQ25895TempZones::decodeNtc(uint8_t faultReg) {
+    switch (faultReg & 0x03) {
+        case 0x01: return BQ25895TempZone::COLD;
+        case 0x02: return BQ25895TempZone::HOT;
+        default: return BQ25895TempZone::NORMAL;
+    }
+}
+
+uint8_t BQ25895TempZones::lookup(int32_t tsVoltage) const {
+    uint8_t index = 0;
+    while (index + 1 < count_ && tsVoltage >= rules_[index + 1].tsAboveMV) {
+        index++;
+    }
+    return index;
+}
+
+bool BQ25895TempZones::update(uint16_t tsVoltage, uint8_t faultReg) {
+    if (count_ == 0 || tsVoltage == 0) {
+        return false;
+    }
+    tsVoltage_ = tsVoltage;
+    hardwareZone_ = decodeNtc(faultReg);
+
+    uint8_t next = lookup(tsVoltage);
+    if (started_ && next != index_) {
+        // Moving further from NORMAL is immediate; moving back needs the hysteresis
+        uint8_t awayFrom = index_ > normal_ ? index_ - normal_ : normal_ - index_;
+        uint8_t awayTo = next > normal_ ? next - normal_ : normal_ - next;
+        if (awayTo <= awayFrom) {
+            int32_t shifted = next > index_ ? static_cast<int32_t>(tsVoltage) - hysteresisMV_
+                                            : static_cast<int32_t>(tsVoltage) + hysteresisMV_;
+            next = lookup(shifted);
+        }
+    }
+
+    bool changed = !started_ || next != index_;
+    if (started_ && changed) {
+        transitions_++;
+    }
+    started_ = true;
+    index_ = next;
+    return changed;
+}
+
+BQ25895TempZoneState BQ25895TempZones::state() const {
+    BQ25895TempZoneState state;
+    state.enabled = enabled();
+    if (!enabled() || !started_) {
+        return state;
+    }
+    state.ruleZone = rules_[index_].zone;
+    state.hardwareZone = hardwareZone_;
+    state.zone = hardwareZone_ != BQ25895TempZone::NORMAL ? hardwareZone_ : state.ruleZone;
+    state.tsVoltage = tsVoltage_;
+    state.chargePercent = rules_[index_].chargePercent;
+    state.chargeVoltageMV = rules_[index_].chargeVoltageMV;
+    state.transitions = transitions_;
+    return state;
+}
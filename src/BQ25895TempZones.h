@@ -0,0 +1,89 @@
+#ifndef BQ25895_TEMP_ZONES_H
+#define BQ25895_TEMP_ZONES_H
+
+#include <stdint.h>
+
+// Battery temperature zones, coldest to hottest
+enum class BQ25895TempZone : uint8_t {
+  UNKNOWN = 0,    // No TS sample yet
+  COLD = 1,       // Charging suspended
+  COOL = 2,       // Reduced charge current
+  NORMAL = 3,
+  WARM = 4,       // Reduced charge voltage
+  HOT = 5         // Charging suspended
+};
+
+// Software zone rule. TS falls as the NTC heats up, so a rule applies while TS is at or
+// above tsAboveMV and below the next rule's threshold. Thresholds use the same scale as
+// BQ25895Metrics::tsVoltage.
+struct BQ25895TempZoneRule {
+  uint16_t tsAboveMV;
+  BQ25895TempZone zone;
+  uint8_t chargePercent;      // ICHG as a percentage of the base target (0 = no charge current)
+  uint16_t chargeVoltageMV;   // VREG cap (0 = base target)
+};
+
+// JEITA-style default for the datasheet divider (103AT, RT1 5.21k, RT2 29.87k):
+// cold below 0C (VLTF), cool to ~10C at half current, warm from ~42C to VHTF at 4.1V
+#define BQ25895_DEFAULT_ZONE_RULES 5
+#define BQ25895_MAX_ZONE_RULES 8
+extern const BQ25895TempZoneRule BQ25895DefaultZoneRules[BQ25895_DEFAULT_ZONE_RULES];
+
+// Boost mode hot threshold (REG01 BHOT)
+enum class BQ25895BoostHot : uint8_t {
+  VBHOT1 = 0,     // 34.75% of REGN (default)
+  VBHOT0 = 1,     // 37.75%
+  VBHOT2 = 2,     // 31.25%, about 65C with a 103AT
+  DISABLED = 3
+};
+
+struct BQ25895TempZoneConfig {
+  const BQ25895TempZoneRule* rules = BQ25895DefaultZoneRules;  // Ascending tsAboveMV, first normally 0
+  uint8_t ruleCount = BQ25895_DEFAULT_ZONE_RULES;
+  uint16_t hysteresisMV = 50;                 // TS must pass this far back to return toward NORMAL
+  BQ25895BoostHot boostHot = BQ25895BoostHot::VBHOT1;
+  bool boostColdMinus20C = false;             // REG01 BCOLD: VBCOLD1 (80%) instead of VBCOLD0 (77%)
+};
+
+struct BQ25895TempZoneState {
+  bool enabled = false;
+  BQ25895TempZone zone = BQ25895TempZone::UNKNOWN;          // Effective zone (hardware overrides software)
+  BQ25895TempZone hardwareZone = BQ25895TempZone::UNKNOWN;  // REG0C NTC_FAULT: COLD, NORMAL or HOT
+  BQ25895TempZone ruleZone = BQ25895TempZone::UNKNOWN;      // Software table
+  uint16_t tsVoltage = 0;
+  uint8_t chargePercent = 100;
+  uint16_t chargeVoltageMV = 0;
+  uint16_t transitions = 0;                   // Rule changes (each one at most one register write)
+};
+
+// The BQ25895 has a single cold/hot window (TS_PROFILE is fixed at 0); the JEITA cool and
+// warm bands are provided by a software rule table on top of the hardware NTC comparators.
+class BQ25895TempZones {
+public:
+  bool configure(const BQ25895TempZoneConfig& config);  // false if the table is invalid
+  void disable() { count_ = 0; }
+  bool enabled() const { return count_ > 0; }
+
+  // REG0C[2:0] NTC_FAULT in buck or boost mode
+  static BQ25895TempZone decodeNtc(uint8_t faultReg);
+
+  // Returns true when the software rule changed (charge targets need to be reapplied)
+  bool update(uint16_t tsVoltage, uint8_t faultReg);
+  const BQ25895TempZoneRule& rule() const { return rules_[index_]; }
+  BQ25895TempZoneState state() const;
+
+private:
+  uint8_t lookup(int32_t tsVoltage) const;
+
+  BQ25895TempZoneRule rules_[BQ25895_MAX_ZONE_RULES];
+  uint8_t count_ = 0;
+  uint8_t index_ = 0;
+  uint8_t normal_ = 0;                // Rule index of the NORMAL zone (hysteresis points toward it)
+  uint16_t hysteresisMV_ = 0;
+  bool started_ = false;
+  uint16_t tsVoltage_ = 0;
+  BQ25895TempZone hardwareZone_ = BQ25895TempZone::UNKNOWN;
+  uint16_t transitions_ = 0;
+};
+
+#endif // BQ25895_TEMP_ZONES_H
@@ -0,0 +1,119 @@
+#include "BQ25895ThermalGovernor.h"
+
+void BQ25895ThermalGovernor::configure(const BQ25895ThermalConfig& config, uint16_t configuredChargeMA) {
+    config_ = config;
+    if (config_.maxChargeMA == 0) {
+        config_.maxChargeMA = configuredChargeMA;
+    }
+    minChargeMA_ = config_.minChargeMA;
+    if (config_.minChargeMA > config_.maxChargeMA) {
+        config_.minChargeMA = config_.maxChargeMA;
+    }
+    enabled_ = true;
+    setpointMA_ = config_.maxChargeMA;
+    tsFilteredX16_ = 0;
+    warm_ = false;
+    regulation_ = false;
+    steppedDown_ = false;
+    limitMA_ = 0;
+    wasRegulating_ = false;
+    regulationSamples_ = 0;
+    stepsDown_ = 0;
+    stepsUp_ = 0;
+}
+
+void BQ25895ThermalGovernor::setCeiling(uint16_t maxChargeMA) {
+    // An unthrottled setpoint follows the ceiling both ways; a throttled one is only clamped
+    if (setpointMA_ >= config_.maxChargeMA || setpointMA_ > maxChargeMA) {
+        setpointMA_ = maxChargeMA;
+    }
+    config_.maxChargeMA = maxChargeMA;
+    config_.minChargeMA = minChargeMA_ < maxChargeMA ? minChargeMA_ : maxChargeMA;
+}
+
+bool BQ25895ThermalGovernor::update(uint32_t timestamp, bool charging, bool thermalRegulation,
+                                    uint16_t tsVoltage, uint16_t& setpointMA) {
+    if (!enabled_) {
+        return false;
+    }
+
+    // TS EMA with 1/4 weight
+    uint32_t sampleX16 = static_cast<uint32_t>(tsVoltage) * 16;
+    if (tsFilteredX16_ == 0) {
+        tsFilteredX16_ = sampleX16;
+    } else if (sampleX16 > tsFilteredX16_) {
+        tsFilteredX16_ += (sampleX16 - tsFilteredX16_) / 4;
+    } else {
+        tsFilteredX16_ -= (tsFilteredX16_ - sampleX16) / 4;
+    }
+    uint16_t filtered = static_cast<uint16_t>(tsFilteredX16_ / 16);
+    if (filtered < config_.tsWarmMV) {
+        warm_ = true;
+    } else if (filtered >= config_.tsWarmMV + config_.tsHysteresisMV) {
+        warm_ = false;
+    }
+    regulation_ = thermalRegulation;
+    if (thermalRegulation && regulationSamples_ < 0xFFFF) {
+        regulationSamples_++;
+    }
+
+    if (!charging) {
+        return false;
+    }
+
+    // Remember where regulation started so probing stops one step short of it
+    if (thermalRegulation && !wasRegulating_ && (limitMA_ == 0 || setpointMA_ < limitMA_)) {
+        limitMA_ = setpointMA_;
+    }
+    wasRegulating_ = thermalRegulation;
+    if (thermalRegulation) {
+        limitTime_ = timestamp;
+    } else if (limitMA_ != 0 && timestamp - limitTime_ >= config_.limitMemoryMs) {
+        limitMA_ = 0;  // Conditions may have changed; allow probing to the ceiling again
+    }
+    uint16_t ceiling = config_.maxChargeMA;
+    if (limitMA_ != 0 && limitMA_ - config_.stepUpMA < ceiling) {
+        ceiling = limitMA_ > config_.minChargeMA + config_.stepUpMA ? limitMA_ - config_.stepUpMA
+                                                                    : config_.minChargeMA;
+    }
+
+    uint16_t next = setpointMA_;
+    if (thermalRegulation || warm_) {
+        if (steppedDown_ && timestamp - lastDown_ < config_.stepDownIntervalMs) {
+            return false;
+        }
+        next = setpointMA_ > config_.minChargeMA + config_.stepDownMA ? setpointMA_ - config_.stepDownMA
+                                                                      : config_.minChargeMA;
+        steppedDown_ = true;
+        lastDown_ = timestamp;
+        if (next == setpointMA_) {
+            return false;
+        }
+        stepsDown_++;
+    } else if (setpointMA_ < ceiling && timestamp - lastChange_ >= config_.holdMs) {
+        next = ceiling - setpointMA_ > config_.stepUpMA ? setpointMA_ + config_.stepUpMA : ceiling;
+        stepsUp_++;
+    } else {
+        return false;
+    }
+
+    setpointMA_ = next;
+    lastChange_ = timestamp;
+    setpointMA = next;
+    return true;
+}
+
+BQ25895ThermalState BQ25895ThermalGovernor::state() const {
+    BQ25895ThermalState state;
+    state.enabled = enabled_;
+    state.setpointMA = setpointMA_;
+    state.maxChargeMA = config_.maxChargeMA;
+    state.regulationLimitMA = limitMA_;
+    state.filteredTsMV = static_cast<uint16_t>(tsFilteredX16_ / 16);
+    state.thermalRegulation = regulation_;
+    state.batteryWarm = warm_;
+    state.regulationSamples = regulationSamples_;
+    state.stepsDown = stepsDown_;
+    state.stepsUp = stepsUp_;
+    return state;
+}
@@ -0,0 +1,70 @@
+#ifndef BQ25895_THERMAL_GOVERNOR_H
+#define BQ25895_THERMAL_GOVERNOR_H
+
+#include <stdint.h>
+
+struct BQ25895ThermalConfig {
+  uint16_t maxChargeMA = 0;            // Ceiling; 0 = the configured ICHG when enabled
+  uint16_t minChargeMA = 512;          // Floor the governor never goes below
+  uint16_t stepDownMA = 128;
+  uint16_t stepUpMA = 64;
+  uint16_t tsWarmMV = 2400;            // Filtered TS below this counts as a warm battery (NTC);
+                                       // the default zones' NORMAL/WARM boundary, above VHTF
+  uint16_t tsHysteresisMV = 100;       // TS must recover this far above tsWarmMV
+  uint32_t stepDownIntervalMs = 5000;  // Persistent regulation steps down at most this often
+  uint32_t holdMs = 60000;             // Quiet time before probing one step higher
+  uint32_t limitMemoryMs = 600000;     // Setpoint that hit regulation stays off-limits this long
+};
+
+struct BQ25895ThermalState {
+  bool enabled = false;
+  uint16_t setpointMA = 0;             // ICHG currently requested
+  uint16_t maxChargeMA = 0;
+  uint16_t regulationLimitMA = 0;      // Lowest setpoint that triggered THERM_STAT recently (0 = none)
+  uint16_t filteredTsMV = 0;
+  bool thermalRegulation = false;      // REG0E THERM_STAT in the last sample
+  bool batteryWarm = false;            // Filtered TS in the warm band
+  uint16_t regulationSamples = 0;      // Samples that reported THERM_STAT
+  uint16_t stepsDown = 0;
+  uint16_t stepsUp = 0;
+};
+
+// Closed-loop ICHG governor that keeps the charger just below thermal regulation.
+// The IC's own regulation folds current back hard and late; stepping down on the first
+// THERM_STAT report and probing back up slowly holds a higher average current.
+// Integer only: TS is filtered as an EMA in 1/16 mV.
+class BQ25895ThermalGovernor {
+public:
+  void configure(const BQ25895ThermalConfig& config, uint16_t configuredChargeMA);
+  void disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+  uint16_t maxChargeMA() const { return config_.maxChargeMA; }
+  uint16_t setpointMA() const { return setpointMA_; }
+  void setCeiling(uint16_t maxChargeMA);  // e.g. a new step-charging stage; clamps the setpoint
+
+  // Returns true when ICHG should be changed to setpointMA
+  bool update(uint32_t timestamp, bool charging, bool thermalRegulation, uint16_t tsVoltage,
+              uint16_t& setpointMA);
+
+  BQ25895ThermalState state() const;
+
+private:
+  BQ25895ThermalConfig config_;
+  uint16_t minChargeMA_ = 0;           // Configured floor (config_ holds it clamped to the ceiling)
+  bool enabled_ = false;
+  uint16_t setpointMA_ = 0;
+  uint32_t tsFilteredX16_ = 0;         // 0 = no sample yet
+  bool warm_ = false;
+  bool regulation_ = false;
+  bool steppedDown_ = false;           // lastDown_ is valid
+  uint32_t lastDown_ = 0;
+  uint32_t lastChange_ = 0;
+  uint16_t limitMA_ = 0;               // Probing stays below this until limitMemoryMs passes
+  uint32_t limitTime_ = 0;
+  bool wasRegulating_ = false;         // Previous charging sample reported THERM_STAT
+  uint16_t regulationSamples_ = 0;
+  uint16_t stepsDown_ = 0;
+  uint16_t stepsUp_ = 0;
+};
+
+#endif // BQ25895_THERMAL_GOVERNOR_H
@@ -0,0 +1,119 @@
+#include "BQ25895VindpmTracker.h"
+
+void BQ25895VindpmTracker::configure(const BQ25895VindpmConfig& config, uint16_t currentVindpmMV) {
+    config_ = config;
+    if (config_.stepMV == 0) {
+        config_.stepMV = 100;
+    }
+    enabled_ = true;
+    stepsDown_ = 0;
+    stepsUp_ = 0;
+    collapses_ = 0;
+    rebase(currentVindpmMV);
+}
+
+void BQ25895VindpmTracker::rebase(uint16_t vindpmMV) {
+    ceilingMV_ = config_.maxMV != 0 ? config_.maxMV : vindpmMV;
+    vindpmMV_ = vindpmMV;
+    floorMV_ = 0;
+    probing_ = false;
+    holding_ = false;
+    lastChange_ = 0;
+}
+
+bool BQ25895VindpmTracker::step(uint32_t timestamp, uint16_t nextMV, uint16_t& out) {
+    if (nextMV > ceilingMV_) {
+        nextMV = ceilingMV_;
+    }
+    if (nextMV == vindpmMV_) {
+        return false;
+    }
+    if (nextMV > vindpmMV_) {
+        if (stepsUp_ < 0xFFFF) stepsUp_++;
+    } else if (stepsDown_ < 0xFFFF) {
+        stepsDown_++;
+    }
+    vindpmMV_ = nextMV;
+    lastChange_ = timestamp;
+    out = nextMV;
+    return true;
+}
+
+bool BQ25895VindpmTracker::update(uint32_t timestamp, uint16_t vbusMV, uint16_t batteryMV, uint16_t chargeMA,
+                                  bool vindpmActive, bool iindpmActive, uint16_t& nextMV) {
+    if (!enabled_) {
+        return false;
+    }
+    vbusMV_ = vbusMV;
+    powerMW_ = static_cast<uint32_t>(batteryMV) * chargeMA / 1000;
+    vindpmActive_ = vindpmActive;
+    iindpmActive_ = iindpmActive;
+
+    // The source gave way under the current threshold: back off at once, whatever the rate limit
+    if (vbusMV + config_.collapseMV < vindpmMV_) {
+        if (collapses_ < 0xFFFF) collapses_++;
+        floorMV_ = vindpmMV_ + config_.stepMV;
+        probing_ = false;
+        holding_ = true;
+        holdUntil_ = timestamp + config_.holdMs;
+        return step(timestamp, vindpmMV_ + config_.stepMV, nextMV);
+    }
+
+    if (timestamp - lastChange_ < config_.settleMs) {
+        return false;
+    }
+
+    // Charge power is the figure of merit; without charging a probe cannot be judged
+    if (probing_) {
+        probing_ = false;
+        if (powerMW_ != 0 && powerMW_ * 100 < powerBeforeMW_ * (100 + config_.minGainPercent)) {
+            // The step down did not pay: the source is at its limit
+            floorMV_ = vindpmMV_ + config_.stepMV;
+            holding_ = true;
+            holdUntil_ = timestamp + config_.holdMs;
+            return step(timestamp, vindpmMV_ + config_.stepMV, nextMV);
+        }
+    }
+    if (holding_) {
+        if (static_cast<int32_t>(timestamp - holdUntil_) < 0) {
+            return false;
+        }
+        holding_ = false;
+    }
+
+    if (vindpmActive && !iindpmActive && powerMW_ != 0) {
+        if (vindpmMV_ < config_.minMV + config_.stepMV) {
+            return false;
+        }
+        probing_ = true;
+        powerBeforeMW_ = powerMW_;
+        return step(timestamp, vindpmMV_ - config_.stepMV, nextMV);
+    }
+
+    // Not voltage limited with room to spare: restore protection toward the ceiling
+    if (!vindpmActive && vindpmMV_ < ceilingMV_ &&
+        vbusMV >= vindpmMV_ + config_.stepMV + config_.collapseMV) {
+        return step(timestamp, vindpmMV_ + config_.stepMV, nextMV);
+    }
+    return false;
+}
+
+BQ25895VindpmState BQ25895VindpmTracker::state() const {
+    BQ25895VindpmState state;
+    state.enabled = enabled_;
+    if (!enabled_) {
+        return state;
+    }
+    state.vindpmMV = vindpmMV_;
+    state.ceilingMV = ceilingMV_;
+    state.floorMV = floorMV_;
+    state.vbusMV = vbusMV_;
+    state.chargePowerMW = powerMW_;
+    state.vindpmActive = vindpmActive_;
+    state.iindpmActive = iindpmActive_;
+    state.stepsDown = stepsDown_;
+    state.stepsUp = stepsUp_;
+    state.collapses = collapses_;
+    state.lastChange = lastChange_;
+    return state;
+}
@@ -0,0 +1,75 @@
+#ifndef BQ25895_VINDPM_TRACKER_H
+#define BQ25895_VINDPM_TRACKER_H
+
+#include <stdint.h>
+
+struct BQ25895VindpmConfig {
+  uint16_t minMV = 4200;               // Never track below this (keeps VBUS clear of BATV)
+  uint16_t maxMV = 0;                  // Ceiling; 0 = the VINDPM programmed when tracking starts
+  uint16_t stepMV = 100;               // One REG0D LSB
+  uint32_t settleMs = 2000;            // Minimum time between steps
+  uint32_t holdMs = 60000;             // After finding the source's limit, wait this long to probe again
+  uint8_t minGainPercent = 2;          // A step down must raise charge power by this much to stand
+  uint16_t collapseMV = 300;           // VBUS this far below VINDPM means the source gave way
+};
+
+struct BQ25895VindpmState {
+  bool enabled = false;
+  uint16_t vindpmMV = 0;               // Threshold currently programmed
+  uint16_t ceilingMV = 0;
+  uint16_t floorMV = 0;                // Lowest threshold the source held (0 = not found yet)
+  uint16_t vbusMV = 0;
+  uint32_t chargePowerMW = 0;          // BATV x ICHGR at the last sample
+  bool vindpmActive = false;           // REG13 VDPM_STAT
+  bool iindpmActive = false;           // REG13 IDPM_STAT
+  uint16_t stepsDown = 0;
+  uint16_t stepsUp = 0;
+  uint16_t collapses = 0;
+  uint32_t lastChange = 0;
+};
+
+// Perturb-and-observe on VINDPM. While the charger regulates on input voltage but not on
+// IINLIM, the threshold steps down one LSB at a time, and each step has to buy more
+// charge power. A step that does not, or VBUS collapsing under it, is undone and held.
+// With the source no longer limiting, the threshold climbs back toward the ceiling to
+// keep protection against a sudden collapse.
+class BQ25895VindpmTracker {
+public:
+  void configure(const BQ25895VindpmConfig& config, uint16_t currentVindpmMV);
+  void disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+  uint16_t ceilingMV() const { return ceilingMV_; }
+  uint16_t vindpmMV() const { return vindpmMV_; }
+
+  // New adapter or VINDPM changed by someone else: start again from this threshold
+  void rebase(uint16_t vindpmMV);
+
+  // Returns true when VINDPM should be changed to nextMV
+  bool update(uint32_t timestamp, uint16_t vbusMV, uint16_t batteryMV, uint16_t chargeMA,
+              bool vindpmActive, bool iindpmActive, uint16_t& nextMV);
+
+  BQ25895VindpmState state() const;
+
+private:
+  bool step(uint32_t timestamp, uint16_t nextMV, uint16_t& out);
+
+  BQ25895VindpmConfig config_;
+  bool enabled_ = false;
+  uint16_t ceilingMV_ = 0;
+  uint16_t vindpmMV_ = 0;
+  uint16_t floorMV_ = 0;
+  bool probing_ = false;               // Last change was a step down still being judged
+  uint32_t powerBeforeMW_ = 0;         // Charge power before that step
+  uint32_t lastChange_ = 0;
+  uint32_t holdUntil_ = 0;
+  bool holding_ = false;
+  uint16_t vbusMV_ = 0;
+  uint32_t powerMW_ = 0;
+  bool vindpmActive_ = false;
+  bool iindpmActive_ = false;
+  uint16_t stepsDown_ = 0;
+  uint16_t stepsUp_ = 0;
+  uint16_t collapses_ = 0;
+};
+
+#endif // BQ25895_VINDPM_TRACKER_H
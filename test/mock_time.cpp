@@ -19,6 +19,14 @@ unsigned long millis() {
     return mock_millis;
 }
 
+/**
+ * Mock implementation of Arduino's micros() function
+ * @return Current mock time in microseconds (millisecond resolution)
+ */
+unsigned long micros() {
+    return mock_millis * 1000;
+}
+
 /**
  * Advance the mock time by specified milliseconds
  * @param ms Milliseconds to advance